@@ -1,14 +1,56 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cctype>
+#include <cfloat>
 #include <charconv>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#if !defined(AURIC_JSON_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define AURIC_JSON_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define AURIC_JSON_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <cstdio>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AURIC_JSON_TARGET(features) __attribute__((target(features)))
+#else
+#define AURIC_JSON_TARGET(features)
+#endif
+
 // Helper functions
 constexpr bool isspace(char c) {
     return c == ' ' || c == '\f' || c == '\n' || c == '\r' || c == '\t' || c == '\v';
@@ -18,448 +60,5903 @@ constexpr bool isdigit(char c) {
     return c >= '0' && c <= '9';
 }
 
-struct JsonValue {
+// A JSON value. String is the type of string values and object keys, and
+// Allocator the allocator template used for array and object storage.
+// JsonValue owns all of its data; instantiations with std::string_view strings
+// refer to character data owned elsewhere (see JsonDocument).
+template <typename String = std::string, template <typename> class Allocator = std::allocator>
+struct BasicJsonValue {
 public:
     struct Array;
     struct Object;
 
+    // An integer too large for 64 bits, kept as its JSON text (see
+    // JsonParseOptions::rawBigIntegers).
+    struct RawNumber {
+        String text;
+
+        bool operator==(const RawNumber& other) const {
+            return text == other.text;
+        }
+    };
+
+    using StringType = String;
+    template <typename T>
+    using AllocatorType = Allocator<T>;
+
     using ValueType = std::variant<
         std::nullptr_t,
         bool,
         int,
+        int64_t,
+        uint64_t,
         double,
-        std::string,
+        RawNumber,
+        String,
         Array,
         Object
         >;
 
     struct Array {
-        std::vector<JsonValue> elements;
+        std::vector<BasicJsonValue, Allocator<BasicJsonValue>> elements;
 
-        const JsonValue& operator[](size_t index) const {
+        const BasicJsonValue& operator[](size_t index) const {
             return elements[index];
         }
-        JsonValue& operator[](size_t index) {
+        BasicJsonValue& operator[](size_t index) {
             return elements[index];
         }
+
+        bool operator==(const Array& other) const {
+            return elements == other.elements;
+        }
+    };
+
+    // Open-addressing hash table over the keys of an Object, mapping the high
+    // half of each key's hash to its position in members.
+    struct KeyIndex {
+        struct Slot {
+            uint32_t hash = 0;
+            uint32_t position = 0; // index into members plus one, 0 if empty
+        };
+
+        std::vector<Slot, Allocator<Slot>> slots;
+        size_t indexedSize = 0; // members.size() when the table was built
     };
 
     struct Object {
-        std::vector<std::pair<std::string, JsonValue>> members;
+        using Member = std::pair<String, BasicJsonValue>;
 
-        const JsonValue& operator[](std::string_view key) const {
-            for (const auto& [k, v] : members) {
-                if (k == key) {
-                    return v;
-                }
+        // Objects with fewer members are always scanned linearly.
+        static constexpr size_t kIndexThreshold = 32;
+
+        std::vector<Member, Allocator<Member>> members;
+        // Built only by buildIndex(), which parsing with
+        // JsonParseOptions::indexObjects calls for every wide object; lookups
+        // never write it, so const lookups are safe to run concurrently. It is
+        // used while it covers as many members as there are, and only as a
+        // shortcut: lookups confirm the key they land on and scan the members
+        // on a miss, so members can be edited directly. Objects whose size
+        // changed since the last buildIndex() are scanned linearly.
+        KeyIndex keyIndex {};
+
+        const BasicJsonValue& operator[](std::string_view key) const {
+            if (const BasicJsonValue* value = find(key)) {
+                return *value;
             }
             throw std::runtime_error("Key not found: " + std::string(key));
         }
-        JsonValue& operator[](std::string_view key) {
-            for (auto& [k, v] : members) {
-                if (k == key) {
-                    return v;
-                }
+        BasicJsonValue& operator[](std::string_view key) {
+            if (BasicJsonValue* value = find(key)) {
+                return *value;
             }
             throw std::runtime_error("Key not found: " + std::string(key));
         }
+
+        // Returns the value of the first member named key, or nullptr.
+        const BasicJsonValue* find(std::string_view key) const {
+            const size_t pos = position(key);
+            return pos < members.size() ? &members[pos].second : nullptr;
+        }
+        BasicJsonValue* find(std::string_view key) {
+            const size_t pos = position(key);
+            return pos < members.size() ? &members[pos].second : nullptr;
+        }
+
+        bool contains(std::string_view key) const {
+            return position(key) < members.size();
+        }
+
+        // (Re)builds keyIndex from the current members.
+        void buildIndex() {
+            using Slot = typename KeyIndex::Slot;
+            size_t capacity = 8;
+            while (capacity < members.size() * 2) {
+                capacity *= 2;
+            }
+            // Keep the table in the same memory as the members, so that objects in
+            // a JsonDocument never touch the heap.
+            const Allocator<Slot> alloc(members.get_allocator());
+            if (keyIndex.slots.get_allocator() == alloc) {
+                keyIndex.slots.assign(capacity, Slot {});
+            } else {
+                std::destroy_at(&keyIndex.slots);
+                std::construct_at(&keyIndex.slots, capacity, Slot {}, alloc);
+            }
+            const size_t mask = capacity - 1;
+            for (size_t i = 0; i < members.size(); ++i) {
+                const uint64_t hash = hashKey(members[i].first);
+                size_t slot = hash & mask;
+                for (; keyIndex.slots[slot].position != 0; slot = (slot + 1) & mask) {
+                    const Slot& other = keyIndex.slots[slot];
+                    if (other.hash == static_cast<uint32_t>(hash >> 32) && members[other.position - 1].first == members[i].first) {
+                        break; // duplicate key: the first member wins
+                    }
+                }
+                if (keyIndex.slots[slot].position == 0) {
+                    keyIndex.slots[slot] = { static_cast<uint32_t>(hash >> 32), static_cast<uint32_t>(i + 1) };
+                }
+            }
+            keyIndex.indexedSize = members.size();
+        }
+
+        static constexpr uint64_t hashKey(std::string_view key) {
+            // Mixes eight bytes at a time; good enough to spread keys over the table.
+            constexpr auto load = [](const char* p, size_t n) {
+                uint64_t word = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    word |= uint64_t(static_cast<unsigned char>(p[i])) << (8 * i);
+                }
+                return word;
+            };
+            uint64_t hash = 0x9e3779b97f4a7c15ull ^ key.size();
+            size_t i = 0;
+            for (; i + 8 <= key.size(); i += 8) {
+                hash = (hash ^ load(key.data() + i, 8)) * 0xbf58476d1ce4e5b9ull;
+                hash ^= hash >> 31;
+            }
+            hash = (hash ^ load(key.data() + i, key.size() - i)) * 0x94d049bb133111ebull;
+            return hash ^ (hash >> 29);
+        }
+
+        bool operator==(const Object& other) const {
+            return members == other.members;
+        }
+
+    private:
+        // Position of the first member named key, or members.size().
+        constexpr size_t position(std::string_view key) const {
+            if (members.size() >= kIndexThreshold && keyIndex.indexedSize == members.size()) {
+                const uint64_t hash = hashKey(key);
+                const size_t mask = keyIndex.slots.size() - 1;
+                for (size_t slot = hash & mask; keyIndex.slots[slot].position != 0; slot = (slot + 1) & mask) {
+                    const auto& [slotHash, slotPosition] = keyIndex.slots[slot];
+                    if (slotHash == static_cast<uint32_t>(hash >> 32) && members[slotPosition - 1].first == key) {
+                        return slotPosition - 1;
+                    }
+                }
+            }
+            // Also confirms misses of the index, which is stale if members were
+            // edited without changing their number.
+            for (size_t i = 0; i < members.size(); ++i) {
+                if (members[i].first == key) {
+                    return i;
+                }
+            }
+            return members.size();
+        }
     };
 
-    constexpr JsonValue() = default;
-    constexpr JsonValue(const ValueType& value) : value(value) {}
-    constexpr JsonValue(ValueType&& value) : value(std::move(value)) {}
-
-    constexpr JsonValue(std::nullptr_t) : value(nullptr) {}
-    constexpr JsonValue(bool val) : value(val) {}
-    constexpr JsonValue(int val) : value(val) {}
-    constexpr JsonValue(double val) : value(val) {}
-    constexpr JsonValue(const std::string& val) : value(val) {}
-    constexpr JsonValue(std::string&& val) : value(std::move(val)) {}
-    constexpr JsonValue(std::string_view val) : value(std::string(val)) {}
-    constexpr JsonValue(const char* val) : value(std::string(val)) {}
-    constexpr JsonValue(const Array& arr) : value(arr) {}
-    constexpr JsonValue(Array&& arr) : value(std::move(arr)) {}
-    constexpr JsonValue(const Object& obj) : value(obj) {}
-    constexpr JsonValue(Object&& obj) : value(std::move(obj)) {}
+    constexpr BasicJsonValue() = default;
+    constexpr BasicJsonValue(const ValueType& value) : value(value) {}
+    constexpr BasicJsonValue(ValueType&& value) : value(std::move(value)) {}
+
+    constexpr BasicJsonValue(std::nullptr_t) : value(nullptr) {}
+    constexpr BasicJsonValue(bool val) : value(val) {}
+    constexpr BasicJsonValue(int val) : value(val) {}
+    constexpr BasicJsonValue(int64_t val) : value(val) {}
+    constexpr BasicJsonValue(uint64_t val) : value(val) {}
+    constexpr BasicJsonValue(double val) : value(val) {}
+    constexpr BasicJsonValue(const String& val) : value(val) {}
+    constexpr BasicJsonValue(String&& val) : value(std::move(val)) {}
+    constexpr BasicJsonValue(std::string_view val)
+        requires(!std::is_same_v<String, std::string_view>)
+        : value(String(val)) {}
+    constexpr BasicJsonValue(const char* val) : value(String(val)) {}
+    constexpr BasicJsonValue(const RawNumber& num) : value(num) {}
+    constexpr BasicJsonValue(RawNumber&& num) : value(std::move(num)) {}
+    constexpr BasicJsonValue(const Array& arr) : value(arr) {}
+    constexpr BasicJsonValue(Array&& arr) : value(std::move(arr)) {}
+    constexpr BasicJsonValue(const Object& obj) : value(obj) {}
+    constexpr BasicJsonValue(Object&& obj) : value(std::move(obj)) {}
 
     constexpr bool isNull() const {
-        return JsonValue::isNull(*this);
+        return BasicJsonValue::isNull(*this);
     }
 
     constexpr bool isBool() const {
-        return JsonValue::isBool(*this);
+        return BasicJsonValue::isBool(*this);
     }
 
     constexpr bool isInt() const {
-        return JsonValue::isInt(*this);
+        return BasicJsonValue::isInt(*this);
+    }
+
+    constexpr bool isInt64() const {
+        return BasicJsonValue::isInt64(*this);
+    }
+
+    constexpr bool isUInt64() const {
+        return BasicJsonValue::isUInt64(*this);
     }
 
     constexpr bool isDouble() const {
-        return JsonValue::isDouble(*this);
+        return BasicJsonValue::isDouble(*this);
+    }
+
+    constexpr bool isRawNumber() const {
+        return BasicJsonValue::isRawNumber(*this);
     }
 
     constexpr bool isString() const {
-        return JsonValue::isString(*this);
+        return BasicJsonValue::isString(*this);
     }
 
     constexpr bool isArray() const {
-        return JsonValue::isArray(*this);
+        return BasicJsonValue::isArray(*this);
     }
 
     constexpr bool isObject() const {
-        return JsonValue::isObject(*this);
+        return BasicJsonValue::isObject(*this);
     }
 
     constexpr bool toBool() const {
-        return JsonValue::toBool(*this);
+        return BasicJsonValue::toBool(*this);
     }
 
     constexpr int toInt() const {
-        return JsonValue::toInt(*this);
+        return BasicJsonValue::toInt(*this);
+    }
+
+    constexpr int64_t toInt64() const {
+        return BasicJsonValue::toInt64(*this);
+    }
+
+    constexpr uint64_t toUInt64() const {
+        return BasicJsonValue::toUInt64(*this);
     }
 
     constexpr double toDouble() const {
-        return JsonValue::toDouble(*this);
+        return BasicJsonValue::toDouble(*this);
+    }
+
+    // Copies of the payload, or on a temporary the payload moved out.
+    constexpr String toString() const& {
+        return BasicJsonValue::toString(*this);
+    }
+    constexpr String toString() && {
+        return std::move(*this).asString();
+    }
+
+    constexpr Array toArray() const& {
+        return BasicJsonValue::toArray(*this);
+    }
+    constexpr Array toArray() && {
+        return std::move(*this).asArray();
+    }
+
+    constexpr Object toObject() const& {
+        return BasicJsonValue::toObject(*this);
+    }
+    constexpr Object toObject() && {
+        return std::move(*this).asObject();
+    }
+
+    // The payload by reference, so chained lookups such as
+    // value.asObject()["key"].asArray() never copy. Like the toX accessors
+    // these throw if the value holds another type. On a temporary the payload
+    // is moved out, since a reference into it would dangle.
+    constexpr const String& asString() const& {
+        return payload<String>(*this, "Value is not a string");
+    }
+    constexpr String& asString() & {
+        return payload<String>(*this, "Value is not a string");
+    }
+    constexpr String asString() && {
+        return std::move(payload<String>(*this, "Value is not a string"));
+    }
+
+    constexpr const Array& asArray() const& {
+        return payload<Array>(*this, "Value is not an array");
+    }
+    constexpr Array& asArray() & {
+        return payload<Array>(*this, "Value is not an array");
+    }
+    constexpr Array asArray() && {
+        return std::move(payload<Array>(*this, "Value is not an array"));
     }
 
-    constexpr std::string toString() const {
-        return JsonValue::toString(*this);
+    constexpr const Object& asObject() const& {
+        return payload<Object>(*this, "Value is not an object");
+    }
+    constexpr Object& asObject() & {
+        return payload<Object>(*this, "Value is not an object");
+    }
+    constexpr Object asObject() && {
+        return std::move(payload<Object>(*this, "Value is not an object"));
     }
 
-    constexpr Array toArray() const {
-        return JsonValue::toArray(*this);
+    // The string's characters, valid while the value is alive and unchanged.
+    constexpr std::string_view asStringView() const& {
+        return asString();
     }
+    std::string_view asStringView() && = delete;
 
-    constexpr Object toObject() const {
-        return JsonValue::toObject(*this);
+    // The T held by value, or nullptr if it holds another type. Unlike the toX
+    // accessors this never throws or copies.
+    template <typename T>
+    constexpr const T* tryGet() const {
+        return std::get_if<T>(&value);
+    }
+    template <typename T>
+    constexpr T* tryGet() {
+        return std::get_if<T>(&value);
     }
 
-    static constexpr bool isNull(const JsonValue& value) {
+    static constexpr bool isNull(const BasicJsonValue& value) {
         return std::holds_alternative<std::nullptr_t>(value.value);
     }
 
-    static constexpr bool isBool(const JsonValue& value) {
+    static constexpr bool isBool(const BasicJsonValue& value) {
         return std::holds_alternative<bool>(value.value);
     }
 
-    static constexpr bool isInt(const JsonValue& value) {
+    static constexpr bool isInt(const BasicJsonValue& value) {
         return std::holds_alternative<int>(value.value);
     }
 
-    static constexpr bool isDouble(const JsonValue& value) {
+    static constexpr bool isInt64(const BasicJsonValue& value) {
+        return std::holds_alternative<int64_t>(value.value);
+    }
+
+    static constexpr bool isUInt64(const BasicJsonValue& value) {
+        return std::holds_alternative<uint64_t>(value.value);
+    }
+
+    static constexpr bool isDouble(const BasicJsonValue& value) {
         return std::holds_alternative<double>(value.value);
     }
 
-    static constexpr bool isString(const JsonValue& value) {
-        return std::holds_alternative<std::string>(value.value);
+    static constexpr bool isRawNumber(const BasicJsonValue& value) {
+        return std::holds_alternative<RawNumber>(value.value);
+    }
+
+    static constexpr bool isString(const BasicJsonValue& value) {
+        return std::holds_alternative<String>(value.value);
     }
 
-    static constexpr bool isArray(const JsonValue& value) {
+    static constexpr bool isArray(const BasicJsonValue& value) {
         return std::holds_alternative<Array>(value.value);
     }
 
-    static constexpr bool isObject(const JsonValue& value) {
+    static constexpr bool isObject(const BasicJsonValue& value) {
         return std::holds_alternative<Object>(value.value);
     }
 
-    static constexpr bool toBool(const JsonValue& value) {
+    static constexpr bool toBool(const BasicJsonValue& value) {
         if (!isBool(value)) {
             throw std::runtime_error("Value is not a boolean");
         }
         return std::get<bool>(value.value);
     }
 
-    static constexpr int toInt(const JsonValue& value) {
+    static constexpr int toInt(const BasicJsonValue& value) {
         if (!isInt(value)) {
             throw std::runtime_error("Value is not an integer");
         }
         return std::get<int>(value.value);
     }
 
-    static constexpr double toDouble(const JsonValue& value) {
+    // Parsed integers are stored as the narrowest of int, int64_t and uint64_t
+    // that holds them, so these accept whichever alternative fits.
+    static constexpr int64_t toInt64(const BasicJsonValue& value) {
+        if (const int* n = std::get_if<int>(&value.value))
+            return *n;
+        if (const int64_t* n = std::get_if<int64_t>(&value.value))
+            return *n;
+        if (const uint64_t* n = std::get_if<uint64_t>(&value.value); n && *n <= uint64_t(INT64_MAX))
+            return static_cast<int64_t>(*n);
+        throw std::runtime_error("Value is not a 64-bit integer");
+    }
+
+    static constexpr uint64_t toUInt64(const BasicJsonValue& value) {
+        if (const uint64_t* n = std::get_if<uint64_t>(&value.value))
+            return *n;
+        if (const int* n = std::get_if<int>(&value.value); n && *n >= 0)
+            return static_cast<uint64_t>(*n);
+        if (const int64_t* n = std::get_if<int64_t>(&value.value); n && *n >= 0)
+            return static_cast<uint64_t>(*n);
+        throw std::runtime_error("Value is not an unsigned 64-bit integer");
+    }
+
+    static constexpr double toDouble(const BasicJsonValue& value) {
         if (!isDouble(value)) {
             throw std::runtime_error("Value is not a double");
         }
         return std::get<double>(value.value);
     }
 
-    static constexpr std::string toString(const JsonValue& value) {
-        if (!isString(value)) {
-            throw std::runtime_error("Value is not a string");
-        }
-        return std::get<std::string>(value.value);
+    static constexpr String toString(const BasicJsonValue& value) {
+        return value.asString();
     }
 
-    static constexpr Array toArray(const JsonValue& value) {
-        if (!isArray(value)) {
-            throw std::runtime_error("Value is not an array");
-        }
-        return std::get<Array>(value.value);
+    static constexpr Array toArray(const BasicJsonValue& value) {
+        return value.asArray();
     }
 
-    static constexpr Object toObject(const JsonValue& value) {
-        if (!isObject(value)) {
-            throw std::runtime_error("Value is not an object");
-        }
-        return std::get<Object>(value.value);
+    static constexpr Object toObject(const BasicJsonValue& value) {
+        return value.asObject();
+    }
+
+    friend constexpr bool operator==(const BasicJsonValue& lhs, const BasicJsonValue& rhs) {
+        return lhs.value == rhs.value;
     }
 
     ValueType value;
+
+private:
+    // The T held by self, const if self is.
+    template <typename T, typename Self>
+    static constexpr auto& payload(Self& self, const char* error) {
+        if (auto* held = std::get_if<T>(&self.value))
+            return *held;
+        throw std::runtime_error(error);
+    }
 };
 
-constexpr bool operator==(const JsonValue& lhs, const JsonValue& rhs) {
-    return lhs.value == rhs.value;
-}
+using JsonValue = BasicJsonValue<>;
 
-class JsonParser {
+enum class JsonSimdLevel {
+    Scalar,
+    SSE2,
+    SSE42,
+    AVX2,
+    AVX512 // AVX-512BW
+};
+
+// Bit masks describing one 64-byte block of input, one bit per byte.
+struct JsonBlockMasks {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t structural = 0; // { } [ ] : ,
+    uint64_t whitespace = 0;
+    uint64_t newline = 0;
+};
+
+// Vectorized kernels, each with a scalar reference implementation. Calls
+// without a level run at activeLevel(); the explicit-level overloads, which
+// require a supported level, let tests and benchmarks compare levels. A level
+// without a kernel of its own runs the one of the level below: only UTF-8
+// validation, which needs SSSE3's byte shuffle, has an SSE4.2 kernel.
+class JsonSimd {
 public:
-    constexpr JsonParser() noexcept = default;
-    constexpr ~JsonParser() noexcept = default;
-    constexpr JsonParser(const JsonParser& other) noexcept = default;
-    constexpr JsonParser& operator=(const JsonParser& other) noexcept = default;
-    constexpr JsonParser(JsonParser&& other) noexcept = default;
-    constexpr JsonParser& operator=(JsonParser&& other) noexcept = default;
+    static constexpr size_t kBlockSize = 64;
 
-    static constexpr JsonValue parse(std::string_view json) {
-        size_t pos = 0;
-        skipWhitespace(json, pos);
-        return parseValue(json, pos);
+    // Best level supported by the running CPU, detected once.
+    static JsonSimdLevel detectedLevel() {
+        static const JsonSimdLevel level = detectLevel();
+        return level;
     }
 
-private:
-    static constexpr void skipWhitespace(std::string_view json, size_t& pos) {
-        while (pos < json.size() && isspace(json[pos]))
-            ++pos;
+    static bool isSupported(JsonSimdLevel level) {
+        return level <= detectedLevel();
     }
 
-    static constexpr char peek(std::string_view json, size_t pos) {
-        if (pos >= json.size())
-            throw std::runtime_error("Unexpected end of JSON");
-        return json[pos];
+    // The level kernels run at: detectedLevel(), unless lowered by the
+    // AURIC_JSON_SIMD environment variable (see parseLevel) when first used or
+    // by setLevel.
+    static JsonSimdLevel activeLevel() {
+        return active().load(std::memory_order_relaxed);
     }
 
-    static constexpr char consume(std::string_view json, size_t& pos) {
-        if (pos >= json.size())
-            throw std::runtime_error("Unexpected end of JSON");
-        return json[pos++];
+    // Runs kernels at level, or the best supported level below it, and
+    // returns the level now in effect. Parses already running may see either.
+    static JsonSimdLevel setLevel(JsonSimdLevel level) {
+        level = std::min(level, detectedLevel());
+        active().store(level, std::memory_order_relaxed);
+        return level;
     }
 
-    static constexpr JsonValue parseValue(std::string_view json, size_t& pos) {
-        switch (peek(json, pos)) {
-        case 'n': return parseNull(json, pos);
-        case 't': return parseTrue(json, pos);
-        case 'f': return parseFalse(json, pos);
-        case '"': return parseString(json, pos);
-        case '[': return parseArray(json, pos);
-        case '{': return parseObject(json, pos);
-        default: return parseNumber(json, pos);
+    // Accepts the names levelName returns.
+    static std::optional<JsonSimdLevel> parseLevel(std::string_view name) {
+        for (const auto level : { JsonSimdLevel::Scalar, JsonSimdLevel::SSE2, JsonSimdLevel::SSE42, JsonSimdLevel::AVX2, JsonSimdLevel::AVX512 }) {
+            if (name == levelName(level))
+                return level;
         }
+        return std::nullopt;
     }
 
-    static constexpr std::nullptr_t parseNull(std::string_view json, size_t& pos) {
-        constexpr auto null = std::string_view("ull");
-        if (json.find(null, pos + 1) == pos + 1) {
-            pos += null.size() + 1;
-            return nullptr;
+    static constexpr const char* levelName(JsonSimdLevel level) {
+        switch (level) {
+        case JsonSimdLevel::SSE2: return "sse2";
+        case JsonSimdLevel::SSE42: return "sse4.2";
+        case JsonSimdLevel::AVX2: return "avx2";
+        case JsonSimdLevel::AVX512: return "avx512";
+        default: return "scalar";
         }
-        throw std::runtime_error("Invalid JSON: expected 'null'");
     }
 
-    static constexpr bool parseTrue(std::string_view json, size_t& pos) {
-        constexpr auto str = std::string_view("rue");
-        if (json.find(str, pos + 1) == pos + 1) {
-            pos += str.size() + 1;
-            return true;
+    static JsonBlockMasks classifyBlock(const char* block, JsonSimdLevel level) {
+        switch (level) {
+#if AURIC_JSON_X86
+        case JsonSimdLevel::AVX512: return classifyBlockAvx512(block);
+        case JsonSimdLevel::AVX2: return classifyBlockAvx2(block);
+        case JsonSimdLevel::SSE42:
+        case JsonSimdLevel::SSE2: return classifyBlockSse2(block);
+#endif
+        default: return classifyBlockScalar(block);
         }
-        throw std::runtime_error("Invalid JSON: expected 'true'");
     }
 
-    static constexpr bool parseFalse(std::string_view json, size_t& pos) {
-        constexpr auto str = std::string_view("alse");
-        if (json.find(str, pos + 1) == pos + 1) {
-            pos += str.size() + 1;
-            return false;
+    // First byte in [begin, end) that is not whitespace, or end.
+    static const char* skipWhitespace(const char* begin, const char* end) {
+        return skipWhitespace(begin, end, activeLevel());
+    }
+
+    static const char* skipWhitespace(const char* begin, const char* end, JsonSimdLevel level) {
+        WhitespaceKernel kernel;
+        return find(begin, end, level, kernel);
+    }
+
+    // First quote or backslash in [begin, end), or end.
+    static const char* findQuoteOrBackslash(const char* begin, const char* end) {
+        return findQuoteOrBackslash(begin, end, activeLevel());
+    }
+
+    static const char* findQuoteOrBackslash(const char* begin, const char* end, JsonSimdLevel level) {
+        QuoteKernel kernel;
+        return find(begin, end, level, kernel);
+    }
+
+    // Also sets nonAscii if a byte before the one found is not ASCII, which
+    // tells the parser whether a string needs UTF-8 validation.
+    static const char* findQuoteOrBackslash(const char* begin, const char* end, bool& nonAscii) {
+        return findQuoteOrBackslash(begin, end, nonAscii, activeLevel());
+    }
+
+    static const char* findQuoteOrBackslash(const char* begin, const char* end, bool& nonAscii, JsonSimdLevel level) {
+        StringKernel kernel;
+        const char* found = find(begin, end, level, kernel);
+        nonAscii |= kernel.nonAscii;
+        return found;
+    }
+
+    // First byte in [begin, end) that must be escaped in a JSON string: a quote,
+    // a backslash or a control character. Returns end if there is none.
+    static const char* findEscape(const char* begin, const char* end) {
+        return findEscape(begin, end, activeLevel());
+    }
+
+    static const char* findEscape(const char* begin, const char* end, JsonSimdLevel level) {
+        EscapeKernel kernel;
+        return find(begin, end, level, kernel);
+    }
+
+    // First byte in [begin, end) that is not an ASCII digit, or end.
+    static const char* findNonDigit(const char* begin, const char* end) {
+        return findNonDigit(begin, end, activeLevel());
+    }
+
+    static const char* findNonDigit(const char* begin, const char* end, JsonSimdLevel level) {
+        DigitKernel kernel;
+        return find(begin, end, level, kernel);
+    }
+
+    // Start of the first malformed, overlong, surrogate or out-of-range UTF-8
+    // sequence in [begin, end), or end if it is all valid. Leading ASCII is
+    // skipped a register at a time; from SSE4.2 up the rest is checked by table
+    // lookups (see validateUtf8Lookup), otherwise one sequence at a time.
+    static const char* validateUtf8(const char* begin, const char* end) {
+        return validateUtf8(begin, end, activeLevel());
+    }
+
+    static const char* validateUtf8(const char* begin, const char* end, JsonSimdLevel level) {
+        AsciiKernel ascii;
+        begin = find(begin, end, level, ascii);
+        if (end - begin < 32) // cheaper than loading the tables
+            return validateUtf8Scalar(begin, end);
+        switch (level) {
+#if AURIC_JSON_X86
+        case JsonSimdLevel::AVX512: return validateUtf8Avx512(begin, end);
+        case JsonSimdLevel::AVX2: return validateUtf8Avx2(begin, end);
+        case JsonSimdLevel::SSE42: return validateUtf8Sse42(begin, end);
+#endif
+        default: return validateUtf8Scalar(begin, end);
         }
-        throw std::runtime_error("Invalid JSON: expected 'false'");
     }
 
-    static constexpr std::string parseString(std::string_view json, size_t& pos) {
-        std::string str;
-        consume(json, pos); // consume opening quote
-        while (true) {
-            char c = peek(json, pos);
-            if (c == '"') {
-                ++pos; // consume closing quote
-                break;
-            } else if (c == '\\') {
-                ++pos; // skip escape character
-                c = peek(json, pos);
-                switch (c) {
-                case '"':
-                case '\\':
-                case '/':
-                    str.push_back(c);
-                    ++pos;
-                    break;
-                case 'b': str.push_back('\b'); ++pos; break;
-                case 'f': str.push_back('\f'); ++pos; break;
-                case 'n': str.push_back('\n'); ++pos; break;
-                case 'r': str.push_back('\r'); ++pos; break;
-                case 't': str.push_back('\t'); ++pos; break;
-                case 'u': {
-                    ++pos;
-                    uint32_t codepoint = parseUnicodeEscape(json, pos);
-                    encodeUTF8(str, codepoint);
-                    break;
-                }
-                default:
-                    throw std::runtime_error("Invalid escape sequence");
-                }
-            } else {
-                str.push_back(c);
-                ++pos;
+    static constexpr const char* validateUtf8Scalar(const char* begin, const char* end) {
+        while (begin < end) {
+            if (static_cast<uint8_t>(*begin) < 0x80) {
+                ++begin;
+                continue;
             }
+            const size_t length = utf8SequenceLength(begin, end);
+            if (length == 0)
+                return begin;
+            begin += length;
         }
-        return str;
+        return end;
     }
 
-    static constexpr uint32_t parseUnicodeEscape(std::string_view json, size_t& pos) {
-        uint32_t codepoint = 0;
-        for (int i = 0; i < 4; ++i) {
-            char c = peek(json, pos);
-            uint8_t digit = (c >= 'A') ? (c & 0xDF) - 'A' + 10 : c - '0'; // Directly compute hexadecimal value
-            codepoint = (codepoint << 4) | digit;
-            ++pos;
+    // Length of the valid UTF-8 sequence starting at p, or 0 if it is invalid.
+    static constexpr size_t utf8SequenceLength(const char* p, const char* end) {
+        const auto byte = [&](size_t i) { return static_cast<uint8_t>(p[i]); };
+        const uint8_t lead = byte(0);
+        if (lead < 0x80)
+            return 1;
+        size_t length;
+        uint8_t low = 0x80, high = 0xBF; // range of the second byte
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            if (lead == 0xE0)
+                low = 0xA0; // overlong
+            else if (lead == 0xED)
+                high = 0x9F; // surrogates
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            if (lead == 0xF0)
+                low = 0x90; // overlong
+            else if (lead == 0xF4)
+                high = 0x8F; // beyond U+10FFFF
+        } else {
+            return 0;
+        }
+        if (size_t(end - p) < length || byte(1) < low || byte(1) > high)
+            return 0;
+        for (size_t i = 2; i < length; ++i) {
+            if ((byte(i) & 0xC0) != 0x80)
+                return 0;
         }
-        return codepoint;
+        return length;
     }
 
-    static constexpr void encodeUTF8(std::string& str, uint32_t codepoint) {
-        if (codepoint <= 0x7F) {
-            str.push_back(static_cast<char>(codepoint));
-        } else if (codepoint <= 0x7FF) {
-            str.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
-            str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-        } else if (codepoint <= 0xFFFF) {
-            str.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
-            str.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
-            str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-        } else if (codepoint <= 0x10FFFF) {
-            str.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
-            str.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
-            str.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
-            str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-        } else {
-            throw std::runtime_error("Invalid Unicode codepoint");
+    static constexpr bool needsEscape(char c) {
+        return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+    }
+
+    // Bit i of the result is the XOR of bits 0..i of the input.
+    static constexpr uint64_t prefixXor(uint64_t bits) {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+private:
+    static std::atomic<JsonSimdLevel>& active() {
+        static std::atomic<JsonSimdLevel> level { initialLevel() };
+        return level;
+    }
+
+    static JsonSimdLevel initialLevel() {
+        const char* name = std::getenv("AURIC_JSON_SIMD");
+        const auto level = parseLevel(name ? name : "");
+        return level ? std::min(*level, detectedLevel()) : detectedLevel();
+    }
+
+    static JsonBlockMasks classifyBlockScalar(const char* block) {
+        JsonBlockMasks masks;
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            const uint64_t bit = uint64_t(1) << i;
+            switch (block[i]) {
+            case '"': masks.quote |= bit; break;
+            case '\\': masks.backslash |= bit; break;
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',': masks.structural |= bit; break;
+            case '\n': masks.newline |= bit; [[fallthrough]];
+            default:
+                if (isspace(block[i]))
+                    masks.whitespace |= bit;
+                break;
+            }
         }
+        return masks;
     }
 
-    static JsonValue parseNumber(std::string_view json, size_t& pos) {
-        size_t endPos = pos;
-        bool isFloatingPoint = false;
+    // The search kernels differ only in the bytes they stop at. Each kernel
+    // has a scalar predicate and, on x86, the same test on 16, 32 and 64 bytes
+    // at once, returning one bit per byte; find runs the widest supported one
+    // and finishes the tail with the next narrower. Masks are inverted as
+    // integers: GCC turns a vector NOT into a 512-bit ternlog that leaves the
+    // upper register state dirty for the SSE code after it.
+    struct WhitespaceKernel {
+        static constexpr bool stop(char c) {
+            return !isspace(c);
+        }
+#if AURIC_JSON_X86
+        // '\t' .. '\r' is a contiguous range
+        AURIC_JSON_TARGET("sse2")
+        static uint64_t stop(__m128i v) {
+            const __m128i control = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+            const __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8('\r' - '\t')), control));
+            return movemask(space) ^ 0xFFFF;
+        }
 
-        // Check for optional minus sign
-        if (endPos < json.size() && json[endPos] == '-')
-            ++endPos;
+        AURIC_JSON_TARGET("avx2")
+        static uint64_t stop(__m256i v) {
+            const __m256i control = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+            const __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8('\r' - '\t')), control));
+            return movemask(space) ^ 0xFFFFFFFF;
+        }
 
-        // Parse integer part
-        while (endPos < json.size() && isdigit(json[endPos]))
-            ++endPos;
+        AURIC_JSON_TARGET("avx512f,avx512bw")
+        static uint64_t stop(__m512i v) {
+            return ~(_mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' '))
+                | _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8('\t')), _mm512_set1_epi8('\r' - '\t')));
+        }
+#endif
+    };
 
-        // Check for optional fractional part
-        if (endPos < json.size() && json[endPos] == '.') {
-            isFloatingPoint = true;
-            ++endPos;
-            while (endPos < json.size() && isdigit(json[endPos]))
-                ++endPos;
+    struct QuoteKernel {
+        static constexpr bool stop(char c) {
+            return c == '"' || c == '\\';
+        }
+#if AURIC_JSON_X86
+        AURIC_JSON_TARGET("sse2")
+        static uint64_t stop(__m128i v) {
+            return movemask(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))));
         }
 
-        // Check for optional exponent part
-        if (endPos < json.size() && (json[endPos] == 'e' || json[endPos] == 'E')) {
-            isFloatingPoint = true;
-            ++endPos;
-            if (endPos < json.size() && (json[endPos] == '+' || json[endPos] == '-'))
-                ++endPos;
-            while (endPos < json.size() && isdigit(json[endPos]))
-                ++endPos;
+        AURIC_JSON_TARGET("avx2")
+        static uint64_t stop(__m256i v) {
+            return movemask(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))));
         }
 
-        if (isFloatingPoint) {
-            // Floating-point number
-            double num;
-            auto result = std::from_chars(json.data() + pos, json.data() + endPos, num);
+        AURIC_JSON_TARGET("avx512f,avx512bw")
+        static uint64_t stop(__m512i v) {
+            return _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"')) | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+        }
+#endif
+    };
 
-            if (result.ec != std::errc()) {
-                throw std::runtime_error("Invalid number format");
-            }
+    // QuoteKernel, noting non-ASCII bytes before the match.
+    struct StringKernel {
+        bool nonAscii = false;
 
-            pos = endPos;
-            return num;
-        } else {
-            // Integer number
-            int num;
-            auto result = std::from_chars(json.data() + pos, json.data() + endPos, num);
+        constexpr bool stop(char c) {
+            nonAscii |= static_cast<uint8_t>(c) >= 0x80;
+            return QuoteKernel::stop(c);
+        }
+#if AURIC_JSON_X86
+        AURIC_JSON_TARGET("sse2")
+        uint64_t stop(__m128i v) {
+            return track(QuoteKernel::stop(v), movemask(v));
+        }
 
-            if (result.ec != std::errc()) {
-                throw std::runtime_error("Invalid number format");
-            }
+        AURIC_JSON_TARGET("avx2")
+        uint64_t stop(__m256i v) {
+            return track(QuoteKernel::stop(v), movemask(v));
+        }
+
+        AURIC_JSON_TARGET("avx512f,avx512bw")
+        uint64_t stop(__m512i v) {
+            return track(QuoteKernel::stop(v), _mm512_movepi8_mask(v));
+        }
+
+        // The high bits below the lowest match, or all of them if there is none
+        uint64_t track(uint64_t match, uint64_t high) {
+            nonAscii |= (high & ((match & (0 - match)) - 1)) != 0;
+            return match;
+        }
+#endif
+    };
+
+    struct EscapeKernel {
+        static constexpr bool stop(char c) {
+            return needsEscape(c);
+        }
+#if AURIC_JSON_X86
+        AURIC_JSON_TARGET("sse2")
+        static uint64_t stop(__m128i v) {
+            return QuoteKernel::stop(v) | movemask(_mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v));
+        }
+
+        AURIC_JSON_TARGET("avx2")
+        static uint64_t stop(__m256i v) {
+            return QuoteKernel::stop(v) | movemask(_mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1F)), v));
+        }
+
+        AURIC_JSON_TARGET("avx512f,avx512bw")
+        static uint64_t stop(__m512i v) {
+            return QuoteKernel::stop(v) | _mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1F));
+        }
+#endif
+    };
+
+    struct DigitKernel {
+        static constexpr bool stop(char c) {
+            return !isdigit(c);
+        }
+#if AURIC_JSON_X86
+        AURIC_JSON_TARGET("sse2")
+        static uint64_t stop(__m128i v) {
+            const __m128i offset = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+            return movemask(_mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(9)), offset)) ^ 0xFFFF;
+        }
+
+        AURIC_JSON_TARGET("avx2")
+        static uint64_t stop(__m256i v) {
+            const __m256i offset = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+            return movemask(_mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(9)), offset)) ^ 0xFFFFFFFF;
+        }
+
+        AURIC_JSON_TARGET("avx512f,avx512bw")
+        static uint64_t stop(__m512i v) {
+            return _mm512_cmpgt_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8('0')), _mm512_set1_epi8(9));
+        }
+#endif
+    };
+
+    struct AsciiKernel {
+        static constexpr bool stop(char c) {
+            return static_cast<unsigned char>(c) >= 0x80;
+        }
+#if AURIC_JSON_X86
+        AURIC_JSON_TARGET("sse2")
+        static uint64_t stop(__m128i v) {
+            return movemask(v);
+        }
+
+        AURIC_JSON_TARGET("avx2")
+        static uint64_t stop(__m256i v) {
+            return movemask(v);
+        }
+
+        AURIC_JSON_TARGET("avx512f,avx512bw")
+        static uint64_t stop(__m512i v) {
+            return _mm512_movepi8_mask(v);
+        }
+#endif
+    };
 
-            pos = endPos;
-            return num;
+    template <typename Kernel>
+    static const char* find(const char* begin, const char* end, JsonSimdLevel level, Kernel& kernel) {
+        switch (level) {
+#if AURIC_JSON_X86
+        case JsonSimdLevel::AVX512: return findAvx512(begin, end, kernel);
+        case JsonSimdLevel::AVX2: return findAvx2(begin, end, kernel);
+        case JsonSimdLevel::SSE42:
+        case JsonSimdLevel::SSE2: return findSse2(begin, end, kernel);
+#endif
+        default: return findScalar(begin, end, kernel);
         }
     }
 
-    static JsonValue parseArray(std::string_view json, size_t& pos) {
-        JsonValue::Array arr;
-        consume(json, pos); // consume opening bracket
-        skipWhitespace(json, pos);
-        if (peek(json, pos) != ']') {
-            size_t elemCount = 0;
-            while (true) {
-                arr.elements.emplace_back(parseValue(json, pos));
-                ++elemCount;
-                skipWhitespace(json, pos);
-                if (peek(json, pos) == ']')
-                    break;
-                if (consume(json, pos) != ',')
-                    throw std::runtime_error("Invalid JSON: expected ',' or ']'");
-                skipWhitespace(json, pos);
-                if (peek(json, pos) == ']')
-                    break; // Allow trailing comma
+    template <typename Kernel>
+    static const char* findScalar(const char* begin, const char* end, Kernel& kernel) {
+        while (begin < end && !kernel.stop(*begin))
+            ++begin;
+        return begin;
+    }
+
+#if AURIC_JSON_X86
+    template <typename Kernel>
+    AURIC_JSON_TARGET("sse2")
+    static const char* findSse2(const char* begin, const char* end, Kernel& kernel) {
+        for (; end - begin >= 16; begin += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            if (const uint64_t mask = kernel.stop(v))
+                return begin + std::countr_zero(mask);
+        }
+        return findScalar(begin, end, kernel);
+    }
+
+    // Most runs the parser scans are short, so the wider kernels look at 16
+    // bytes before they switch to full-width loads.
+    template <typename Kernel>
+    AURIC_JSON_TARGET("avx2")
+    static const char* findAvx2(const char* begin, const char* end, Kernel& kernel) {
+        if (end - begin >= 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            if (const uint64_t mask = kernel.stop(v))
+                return begin + std::countr_zero(mask);
+            begin += 16;
+        }
+        for (; end - begin >= 32; begin += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+            if (const uint64_t mask = kernel.stop(v))
+                return begin + std::countr_zero(mask);
+        }
+        return findSse2(begin, end, kernel);
+    }
+
+    template <typename Kernel>
+    AURIC_JSON_TARGET("avx512f,avx512bw")
+    static const char* findAvx512(const char* begin, const char* end, Kernel& kernel) {
+        if (end - begin >= 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            if (const uint64_t mask = kernel.stop(v))
+                return begin + std::countr_zero(mask);
+            begin += 16;
+        }
+        for (; end - begin >= 64; begin += 64) {
+            const __m512i v = _mm512_loadu_si512(begin);
+            if (const uint64_t mask = kernel.stop(v))
+                return begin + std::countr_zero(mask);
+        }
+        return findAvx2(begin, end, kernel);
+    }
+
+    // Keiser and Lemire's UTF-8 validation by lookup ("Validating UTF-8 in less
+    // than one instruction per byte"). Indexing three tables by the high and
+    // low nibble of each byte's predecessor and the high nibble of the byte
+    // flags every pair of bytes that cannot occur in UTF-8; the second and
+    // third bytes after a three- or four-byte lead are checked to be
+    // continuations separately. A register only tells whether it is valid, so
+    // on an error the scalar reference takes over from the start of the
+    // sequence the register begins in, to report the exact byte.
+    struct Utf8Lookup {
+        static constexpr uint8_t kTooShort = 1 << 0; // lead not followed by a continuation
+        static constexpr uint8_t kTooLong = 1 << 1; // continuation after ASCII
+        static constexpr uint8_t kOverlong3 = 1 << 2;
+        static constexpr uint8_t kTooLarge = 1 << 3;
+        static constexpr uint8_t kSurrogate = 1 << 4;
+        static constexpr uint8_t kOverlong2 = 1 << 5;
+        static constexpr uint8_t kTooLarge1000 = 1 << 6;
+        static constexpr uint8_t kOverlong4 = 1 << 6;
+        static constexpr uint8_t kTwoConts = 1 << 7; // continuation after continuation
+        static constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+        alignas(16) static constexpr uint8_t byte1High[16] = {
+            kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, // ASCII
+            kTwoConts, kTwoConts, kTwoConts, kTwoConts, // continuation
+            kTooShort | kOverlong2, // C0 .. CF
+            kTooShort, // D0 .. DF
+            kTooShort | kOverlong3 | kSurrogate, // E0 .. EF
+            kTooShort | kTooLarge | kTooLarge1000 | kOverlong4 // F0 .. FF
+        };
+        alignas(16) static constexpr uint8_t byte1Low[16] = {
+            kCarry | kOverlong3 | kOverlong2 | kOverlong4, // _0
+            kCarry | kOverlong2, // _1
+            kCarry, kCarry, // _2, _3
+            kCarry | kTooLarge, // _4
+            kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, // _5 .. _7
+            kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000,
+            kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000, // _8 .. _C
+            kCarry | kTooLarge | kTooLarge1000 | kSurrogate, // _D
+            kCarry | kTooLarge | kTooLarge1000, kCarry | kTooLarge | kTooLarge1000 // _E, _F
+        };
+        alignas(16) static constexpr uint8_t byte2High[16] = {
+            kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, // ASCII
+            kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4, // 80 .. 8F
+            kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge, // 90 .. 9F
+            kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge, // A0 .. AF
+            kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge, // B0 .. BF
+            kTooShort, kTooShort, kTooShort, kTooShort // leads
+        };
+        // Bytes above these in the last three positions of the input start an
+        // incomplete sequence
+        alignas(16) static constexpr uint8_t incompleteMax[16] = {
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+        };
+    };
+
+    // Where the scalar reference resumes when the register at p is invalid:
+    // the lead byte of a sequence crossing into it, or p.
+    static const char* utf8Resync(const char* begin, const char* p) {
+        const char* q = p;
+        while (q > begin && p - q < 3 && (static_cast<uint8_t>(q[-1]) & 0xC0) == 0x80)
+            --q;
+        if (q > begin && static_cast<uint8_t>(q[-1]) >= 0xC0)
+            --q;
+        return q;
+    }
+
+    AURIC_JSON_TARGET("sse4.2")
+    static const char* validateUtf8Sse42(const char* begin, const char* end) {
+        const __m128i byte1High = _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte1High));
+        const __m128i byte1Low = _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte1Low));
+        const __m128i byte2High = _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte2High));
+        const __m128i incompleteMax = _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::incompleteMax));
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        __m128i prev = _mm_setzero_si128();
+        __m128i incomplete = _mm_setzero_si128();
+        const char* p = begin;
+        for (; p < end; p += 16) {
+            __m128i v;
+            if (end - p >= 16) {
+                v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            } else {
+                alignas(16) char tail[16] = {}; // NUL is ASCII
+                std::memcpy(tail, p, end - p);
+                v = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
             }
-            arr.elements.reserve(elemCount); // Avoid reallocations
+            __m128i error = incomplete;
+            if (_mm_movemask_epi8(v) != 0) {
+                const __m128i prev1 = _mm_alignr_epi8(v, prev, 15);
+                const __m128i special = _mm_and_si128(_mm_and_si128(
+                                                          _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                                                          _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))),
+                    _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+                const __m128i third = _mm_subs_epu8(_mm_alignr_epi8(v, prev, 14), _mm_set1_epi8(char(0xE0 - 0x80)));
+                const __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(v, prev, 13), _mm_set1_epi8(char(0xF0 - 0x80)));
+                const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(char(0x80)));
+                error = _mm_xor_si128(must23, special);
+                incomplete = _mm_subs_epu8(v, incompleteMax);
+            } else {
+                incomplete = _mm_setzero_si128();
+            }
+            if (!_mm_testz_si128(error, error))
+                return validateUtf8Scalar(utf8Resync(begin, p), end);
+            prev = v;
         }
-        consume(json, pos); // consume closing bracket
-        return arr;
+        if (!_mm_testz_si128(incomplete, incomplete))
+            return validateUtf8Scalar(utf8Resync(begin, p - 16), end);
+        return end;
     }
 
-    static JsonValue parseObject(std::string_view json, size_t& pos) {
-        JsonValue::Object obj;
-        consume(json, pos); // consume opening brace
-        skipWhitespace(json, pos);
-        if (peek(json, pos) != '}') {
-            size_t memberCount = 0;
-            while (true) {
-                auto key = parseString(json, pos);
-                skipWhitespace(json, pos);
-                if (consume(json, pos) != ':')
-                    throw std::runtime_error("Invalid JSON: expected ':'");
-                skipWhitespace(json, pos);
-                obj.members.emplace_back(std::move(key), parseValue(json, pos));
-                ++memberCount;
-                skipWhitespace(json, pos);
-                if (peek(json, pos) == '}')
-                    break;
-                if (consume(json, pos) != ',')
-                    throw std::runtime_error("Invalid JSON: expected ',' or '}'");
-                skipWhitespace(json, pos);
-                if (peek(json, pos) == '}')
-                    break; // Allow trailing comma
+    AURIC_JSON_TARGET("avx2")
+    static const char* validateUtf8Avx2(const char* begin, const char* end) {
+        const __m256i byte1High = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte1High)));
+        const __m256i byte1Low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte1Low)));
+        const __m256i byte2High = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte2High)));
+        const __m256i incompleteMax = _mm256_inserti128_si256(_mm256_set1_epi8(char(0xFF)),
+            _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::incompleteMax)), 1);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        __m256i prev = _mm256_setzero_si256();
+        __m256i incomplete = _mm256_setzero_si256();
+        const char* p = begin;
+        for (; p < end; p += 32) {
+            __m256i v;
+            if (end - p >= 32) {
+                v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            } else {
+                alignas(32) char tail[32] = {};
+                std::memcpy(tail, p, end - p);
+                v = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+            }
+            __m256i error = incomplete;
+            if (_mm256_movemask_epi8(v) != 0) {
+                // The previous register's upper lane and this one's lower lane
+                const __m256i shifted = _mm256_permute2x128_si256(prev, v, 0x21);
+                const __m256i prev1 = _mm256_alignr_epi8(v, shifted, 15);
+                const __m256i special = _mm256_and_si256(_mm256_and_si256(
+                                                             _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                                                             _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibble))),
+                    _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+                const __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(v, shifted, 14), _mm256_set1_epi8(char(0xE0 - 0x80)));
+                const __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(v, shifted, 13), _mm256_set1_epi8(char(0xF0 - 0x80)));
+                const __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+                error = _mm256_xor_si256(must23, special);
+                incomplete = _mm256_subs_epu8(v, incompleteMax);
+            } else {
+                incomplete = _mm256_setzero_si256();
             }
-            obj.members.reserve(memberCount); // Avoid reallocations
+            if (!_mm256_testz_si256(error, error))
+                return validateUtf8Scalar(utf8Resync(begin, p), end);
+            prev = v;
         }
-        consume(json, pos); // consume closing brace
-        return obj;
+        if (!_mm256_testz_si256(incomplete, incomplete))
+            return validateUtf8Scalar(utf8Resync(begin, p - 32), end);
+        return end;
     }
-};
 
+    AURIC_JSON_TARGET("avx512f,avx512bw")
+    static const char* validateUtf8Avx512(const char* begin, const char* end) {
+        // The all-ones maskz_ forms avoid GCC 12 -Wuninitialized noise from _mm512_undefined
+        const __m512i byte1High = _mm512_maskz_broadcast_i32x4(__mmask16(0xFFFF), _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte1High)));
+        const __m512i byte1Low = _mm512_maskz_broadcast_i32x4(__mmask16(0xFFFF), _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte1Low)));
+        const __m512i byte2High = _mm512_maskz_broadcast_i32x4(__mmask16(0xFFFF), _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::byte2High)));
+        const __m512i incompleteMax = _mm512_inserti32x4(_mm512_set1_epi8(char(0xFF)),
+            _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8Lookup::incompleteMax)), 3);
+        const __m512i nibble = _mm512_set1_epi8(0x0F);
+        __m512i prev = _mm512_setzero_si512();
+        __m512i incomplete = _mm512_setzero_si512();
+        const char* p = begin;
+        for (; p < end; p += 64) {
+            const size_t n = std::min<size_t>(end - p, 64);
+            const __m512i v = _mm512_maskz_loadu_epi8(n == 64 ? ~__mmask64(0) : (__mmask64(1) << n) - 1, p);
+            __m512i error = incomplete;
+            if (_mm512_movepi8_mask(v) != 0) {
+                // The previous register's top lane, then this one's lower three
+                const __m512i shifted = _mm512_maskz_alignr_epi64(0xFF, v, prev, 6);
+                const __m512i prev1 = _mm512_alignr_epi8(v, shifted, 15);
+                const __m512i special = _mm512_and_si512(_mm512_and_si512(
+                                                             _mm512_shuffle_epi8(byte1High, _mm512_and_si512(_mm512_srli_epi16(prev1, 4), nibble)),
+                                                             _mm512_shuffle_epi8(byte1Low, _mm512_and_si512(prev1, nibble))),
+                    _mm512_shuffle_epi8(byte2High, _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble)));
+                const __m512i third = _mm512_subs_epu8(_mm512_alignr_epi8(v, shifted, 14), _mm512_set1_epi8(char(0xE0 - 0x80)));
+                const __m512i fourth = _mm512_subs_epu8(_mm512_alignr_epi8(v, shifted, 13), _mm512_set1_epi8(char(0xF0 - 0x80)));
+                const __m512i must23 = _mm512_and_si512(_mm512_or_si512(third, fourth), _mm512_set1_epi8(char(0x80)));
+                error = _mm512_xor_si512(must23, special);
+                incomplete = _mm512_subs_epu8(v, incompleteMax);
+            } else {
+                incomplete = _mm512_setzero_si512();
+            }
+            if (_mm512_test_epi8_mask(error, error) != 0)
+                return validateUtf8Scalar(utf8Resync(begin, p), end);
+            prev = v;
+        }
+        if (_mm512_test_epi8_mask(incomplete, incomplete) != 0)
+            return validateUtf8Scalar(utf8Resync(begin, p - 64), end);
+        return end;
+    }
+
+    AURIC_JSON_TARGET("sse2")
+    static JsonBlockMasks classifyBlockSse2(const char* block) {
+        JsonBlockMasks masks;
+        for (size_t i = 0; i < kBlockSize; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+            // '[' and ']' differ from '{' and '}' only in bit 0x20
+            const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+            const __m128i structural = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+
+            masks.quote |= movemask(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << i;
+            masks.backslash |= movemask(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << i;
+            masks.structural |= movemask(structural) << i;
+            masks.whitespace |= (WhitespaceKernel::stop(v) ^ 0xFFFF) << i;
+            masks.newline |= movemask(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))) << i;
+        }
+        return masks;
+    }
+
+    AURIC_JSON_TARGET("avx2")
+    static JsonBlockMasks classifyBlockAvx2(const char* block) {
+        JsonBlockMasks masks;
+        for (size_t i = 0; i < kBlockSize; i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+            const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+            const __m256i structural = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+
+            masks.quote |= movemask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << i;
+            masks.backslash |= movemask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << i;
+            masks.structural |= movemask(structural) << i;
+            masks.whitespace |= (WhitespaceKernel::stop(v) ^ 0xFFFFFFFF) << i;
+            masks.newline |= movemask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))) << i;
+        }
+        return masks;
+    }
+
+    AURIC_JSON_TARGET("avx512f,avx512bw")
+    static JsonBlockMasks classifyBlockAvx512(const char* block) {
+        const __m512i v = _mm512_loadu_si512(block);
+        const __m512i folded = _mm512_or_si512(v, _mm512_set1_epi8(0x20));
+        JsonBlockMasks masks;
+        masks.quote = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'));
+        masks.backslash = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+        masks.structural = _mm512_cmpeq_epi8_mask(folded, _mm512_set1_epi8('{')) | _mm512_cmpeq_epi8_mask(folded, _mm512_set1_epi8('}'))
+            | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(':')) | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(','));
+        masks.whitespace = ~WhitespaceKernel::stop(v);
+        masks.newline = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n'));
+        return masks;
+    }
+
+    AURIC_JSON_TARGET("sse2")
+    static uint64_t movemask(__m128i mask) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(mask));
+    }
+
+    AURIC_JSON_TARGET("avx2")
+    static uint64_t movemask(__m256i mask) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(mask));
+    }
+#endif
+
+    static JsonSimdLevel detectLevel() {
+#if AURIC_JSON_X86 && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return JsonSimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2"))
+            return JsonSimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.2"))
+            return JsonSimdLevel::SSE42;
+        if (__builtin_cpu_supports("sse2"))
+            return JsonSimdLevel::SSE2;
+#elif AURIC_JSON_X86
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool sse2 = (info[3] & (1 << 26)) != 0;
+        const bool sse42 = (info[2] & (1 << 20)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (maxLeaf >= 7 && osxsave) {
+            const unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info, 7, 0);
+            // The OS must save the AVX (and for AVX-512, opmask and ZMM) state
+            if ((xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) && (info[1] & (1 << 30)))
+                return JsonSimdLevel::AVX512;
+            if ((xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)))
+                return JsonSimdLevel::AVX2;
+        }
+        if (sse42)
+            return JsonSimdLevel::SSE42;
+        if (sse2)
+            return JsonSimdLevel::SSE2;
+#endif
+        return JsonSimdLevel::Scalar;
+    }
+};
+
+// Tracks which bytes of consecutive blocks lie inside strings.
+struct JsonStringScanner {
+    uint64_t prevEscaped = 0; // 1 if the first byte of the next block is escaped
+    uint64_t prevInString = 0; // all ones if the next block starts inside a string
+
+    // Returns the unescaped quotes of the block and sets inString to its opening
+    // quotes and string contents; closing quotes are excluded.
+    uint64_t next(const JsonBlockMasks& masks, uint64_t& inString) {
+        // Backslash runs are rare, so resolve them one at a time
+        uint64_t escaped = prevEscaped;
+        uint64_t backslash = masks.backslash & ~prevEscaped;
+        prevEscaped = 0;
+        while (backslash) {
+            const int i = std::countr_zero(backslash);
+            if (i == 63) {
+                prevEscaped = 1;
+                break;
+            }
+            const uint64_t next = uint64_t(1) << (i + 1);
+            escaped |= next;
+            backslash &= ~next;
+            backslash &= backslash - 1;
+        }
+
+        const uint64_t quote = masks.quote & ~escaped;
+        inString = JsonSimd::prefixXor(quote) ^ prevInString;
+        prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+        return quote;
+    }
+};
+
+// Stage 1 of the two-stage parser: the byte offsets of every token in the input.
+// A token is a structural character outside of strings, the opening quote of a
+// string, or the first byte of a literal or number. The list is terminated by a
+// sentinel equal to the input size.
+struct JsonStructuralIndex {
+    std::vector<uint32_t> positions;
+
+    static JsonStructuralIndex build(std::string_view json) {
+        return build(json, JsonSimd::activeLevel());
+    }
+
+    static JsonStructuralIndex build(std::string_view json, JsonSimdLevel level) {
+        if (json.size() >= UINT32_MAX)
+            throw std::runtime_error("JSON too large for structural index");
+        level = std::min(level, JsonSimd::detectedLevel());
+
+        JsonStructuralIndex index;
+        index.positions.reserve(json.size() / 8 + 2);
+
+        JsonStringScanner strings;
+        uint64_t prevScalar = 0; // 1 if the last byte of the previous block belongs to a scalar
+
+        size_t offset = 0;
+        for (; offset + JsonSimd::kBlockSize <= json.size(); offset += JsonSimd::kBlockSize) {
+            const auto masks = JsonSimd::classifyBlock(json.data() + offset, level);
+            index.append(offset, indexBlock(masks, strings, prevScalar));
+        }
+        if (offset < json.size()) {
+            // Pad the tail with whitespace so the kernels never read past the input
+            char tail[JsonSimd::kBlockSize];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, json.data() + offset, json.size() - offset);
+            const auto masks = JsonSimd::classifyBlock(tail, level);
+            index.append(offset, indexBlock(masks, strings, prevScalar));
+        }
+
+        index.positions.push_back(static_cast<uint32_t>(json.size()));
+        return index;
+    }
+
+private:
+    static uint64_t indexBlock(const JsonBlockMasks& masks, JsonStringScanner& strings, uint64_t& prevScalar) {
+        uint64_t inString;
+        const uint64_t quote = strings.next(masks, inString);
+
+        const uint64_t scalar = ~(masks.structural | masks.whitespace | quote) & ~inString;
+        const uint64_t scalarStart = scalar & ~((scalar << 1) | prevScalar);
+        prevScalar = scalar >> 63;
+
+        return (masks.structural & ~inString) | (quote & inString) | scalarStart;
+    }
+
+    void append(size_t offset, uint64_t tokens) {
+        const size_t count = std::popcount(tokens);
+        const size_t size = positions.size();
+        positions.resize(size + count);
+        uint32_t* out = positions.data() + size;
+        while (tokens) {
+            *out++ = static_cast<uint32_t>(offset + std::countr_zero(tokens));
+            tokens &= tokens - 1;
+        }
+    }
+};
+
+enum class JsonErrorCode : uint8_t {
+    None,
+    UnexpectedEnd,
+    UnexpectedCharacter,
+    ExpectedNull,
+    ExpectedTrue,
+    ExpectedFalse,
+    InvalidEscape,
+    InvalidCodepoint,
+    InvalidNumber,
+    ExpectedCommaOrBracket,
+    ExpectedKey,
+    ExpectedColon,
+    ExpectedCommaOrBrace,
+    TrailingData,
+    FileError,
+    UnexpectedType,
+    InvalidBinary,
+    InvalidUtf8,
+    DepthLimitExceeded,
+    InvalidPath,
+    InputTooLarge
+};
+
+// Why and where parsing failed. Converts to true if there is an error.
+struct JsonError {
+    JsonErrorCode code = JsonErrorCode::None;
+    size_t offset = 0; // in bytes from the start of the input
+    size_t line = 0; // 1-based
+    size_t column = 0; // 1-based, in bytes
+
+    // Locates offset within json. Only runs once a parse has failed.
+    static constexpr JsonError at(std::string_view json, size_t offset, JsonErrorCode code) {
+        const std::string_view before = json.substr(0, offset);
+        const size_t lineStart = before.rfind('\n') + 1; // 0 if there is no newline
+        return { code, offset, static_cast<size_t>(std::count(before.begin(), before.end(), '\n')) + 1, offset - lineStart + 1 };
+    }
+
+    static constexpr const char* message(JsonErrorCode code) {
+        switch (code) {
+        case JsonErrorCode::None: return "No error";
+        case JsonErrorCode::UnexpectedEnd: return "Unexpected end of JSON";
+        case JsonErrorCode::UnexpectedCharacter: return "Invalid JSON: unexpected character";
+        case JsonErrorCode::ExpectedNull: return "Invalid JSON: expected 'null'";
+        case JsonErrorCode::ExpectedTrue: return "Invalid JSON: expected 'true'";
+        case JsonErrorCode::ExpectedFalse: return "Invalid JSON: expected 'false'";
+        case JsonErrorCode::InvalidEscape: return "Invalid escape sequence";
+        case JsonErrorCode::InvalidCodepoint: return "Invalid Unicode codepoint";
+        case JsonErrorCode::InvalidNumber: return "Invalid number format";
+        case JsonErrorCode::ExpectedCommaOrBracket: return "Invalid JSON: expected ',' or ']'";
+        case JsonErrorCode::ExpectedKey: return "Invalid JSON: expected string key";
+        case JsonErrorCode::ExpectedColon: return "Invalid JSON: expected ':'";
+        case JsonErrorCode::ExpectedCommaOrBrace: return "Invalid JSON: expected ',' or '}'";
+        case JsonErrorCode::TrailingData: return "Invalid JSON: unexpected data after value";
+        case JsonErrorCode::FileError: return "Could not read JSON file";
+        case JsonErrorCode::UnexpectedType: return "JSON value does not match the target type";
+        case JsonErrorCode::InvalidBinary: return "Invalid binary encoding";
+        case JsonErrorCode::InvalidUtf8: return "Invalid UTF-8 in string";
+        case JsonErrorCode::DepthLimitExceeded: return "JSON nested too deeply";
+        case JsonErrorCode::InvalidPath: return "Invalid JSON path";
+        case JsonErrorCode::InputTooLarge: return "JSON too large";
+        }
+        return "Unknown error";
+    }
+
+    constexpr const char* message() const {
+        return message(code);
+    }
+
+    constexpr explicit operator bool() const {
+        return code != JsonErrorCode::None;
+    }
+};
+
+// Either a parsed T or the JsonError that prevented it, in the manner of
+// std::expected. value() throws the error's message as std::runtime_error,
+// the same exception the throwing parse functions raise.
+template <typename T>
+class JsonResult {
+public:
+    constexpr JsonResult(T value) : state(std::move(value)) {}
+    constexpr JsonResult(const JsonError& error) : state(error) {}
+
+    constexpr bool hasValue() const {
+        return state.index() == 0;
+    }
+
+    constexpr explicit operator bool() const {
+        return hasValue();
+    }
+
+    constexpr T& value() & {
+        check();
+        return std::get<0>(state);
+    }
+    constexpr const T& value() const& {
+        check();
+        return std::get<0>(state);
+    }
+    constexpr T&& value() && {
+        check();
+        return std::get<0>(std::move(state));
+    }
+
+    // Unchecked access; the result must hold a value.
+    constexpr T& operator*() {
+        return *std::get_if<0>(&state);
+    }
+    constexpr const T& operator*() const {
+        return *std::get_if<0>(&state);
+    }
+    constexpr T* operator->() {
+        return std::get_if<0>(&state);
+    }
+    constexpr const T* operator->() const {
+        return std::get_if<0>(&state);
+    }
+
+    // The error, or one with code JsonErrorCode::None if there is a value.
+    constexpr JsonError error() const {
+        return hasValue() ? JsonError {} : std::get<1>(state);
+    }
+
+private:
+    constexpr void check() const {
+        if (!hasValue())
+            throw std::runtime_error(std::get<1>(state).message());
+    }
+
+    std::variant<T, JsonError> state;
+};
+
+// Binary encodings understood by JsonParser::parseBinary and
+// JsonWriter::dumpBinary.
+enum class JsonBinaryFormat : uint8_t {
+    Cbor, // RFC 8949
+    MessagePack
+};
+
+struct JsonParseOptions {
+    // JsonDocument only: strings and keys without escape sequences are stored as
+    // views into the parsed input instead of being copied into the arena, so the
+    // input buffer must outlive the document and stay unmodified. Strings with
+    // escapes are still decoded into the arena.
+    bool borrowStrings = false;
+    // Build the key index of every object with at least
+    // Object::kIndexThreshold members while parsing. Lookups in objects
+    // without one scan their members.
+    bool indexObjects = false;
+    // Integers beyond the 64-bit range are kept as their text in a RawNumber
+    // (or reported through onRawNumber) instead of being rounded to double.
+    bool rawBigIntegers = false;
+    // Reject strings that are not valid UTF-8 with InvalidUtf8 at the first
+    // invalid byte. When off, their bytes are passed through unchecked.
+    bool validateUtf8 = true;
+    // Decode a \\u escape for a UTF-16 surrogate without its partner to U+FFFD
+    // instead of failing with InvalidCodepoint.
+    bool replaceLoneSurrogates = false;
+    // Arrays and objects nested deeper than this fail with DepthLimitExceeded
+    // at the bracket that opens one level too many. The parsers keep their own
+    // stack, but trees are destroyed, compared and written recursively, so
+    // only raise it far for parseSax, parseTape and JsonStreamParser.
+    size_t maxDepth = 1024;
+};
+
+// The contents of a file, mapped read-only where the platform supports it and
+// read into memory otherwise. The parsers never read past the end of their
+// input (stage 1 pads its last block with a copy), so the mapping needs no
+// padding.
+class JsonMappedFile {
+public:
+    JsonMappedFile() = default;
+
+    JsonMappedFile(JsonMappedFile&& other) noexcept
+        : bytes(std::exchange(other.bytes, nullptr))
+        , length(std::exchange(other.length, 0)) {}
+
+    JsonMappedFile& operator=(JsonMappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            bytes = std::exchange(other.bytes, nullptr);
+            length = std::exchange(other.length, 0);
+        }
+        return *this;
+    }
+
+    ~JsonMappedFile() {
+        close();
+    }
+
+    // Replaces the current contents with the file at path. Returns false if it
+    // cannot be read, leaving this empty.
+    bool open(const char* path) {
+        close();
+#if AURIC_JSON_MMAP
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        bool ok = ::fstat(fd, &info) == 0;
+        if (ok && info.st_size > 0) {
+            void* mapping = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ok = mapping != MAP_FAILED;
+            if (ok) {
+                // Parsing reads front to back, once
+                ::madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+                bytes = static_cast<const char*>(mapping);
+                length = info.st_size;
+            }
+        }
+        ::close(fd);
+        return ok;
+#else
+        std::FILE* file = std::fopen(path, "rb");
+        if (!file)
+            return false;
+        bool ok = std::fseek(file, 0, SEEK_END) == 0;
+        const long size = ok ? std::ftell(file) : -1;
+        ok = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+        if (ok && size > 0) {
+            char* buffer = new char[size];
+            ok = std::fread(buffer, 1, size, file) == size_t(size);
+            if (ok) {
+                bytes = buffer;
+                length = size;
+            } else {
+                delete[] buffer;
+            }
+        }
+        std::fclose(file);
+        return ok;
+#endif
+    }
+
+    std::string_view data() const {
+        return { bytes, length };
+    }
+
+private:
+    void close() {
+        if (!bytes)
+            return;
+#if AURIC_JSON_MMAP
+        ::munmap(const_cast<char*>(bytes), length);
+#else
+        delete[] bytes;
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* bytes = nullptr;
+    size_t length = 0;
+};
+
+// A JSON tree whose nodes, containers and strings all live in a monotonic arena
+// owned by the document. Nodes are never destroyed individually: destroying the
+// document releases the arena in one go. Strings are views into the arena and
+// stay valid for the lifetime of the document, unless parsed with
+// JsonParseOptions::borrowStrings, in which case they may also point into the
+// parsed input and are only valid while that input is.
+class JsonDocument {
+public:
+    using Value = BasicJsonValue<std::string_view, std::pmr::polymorphic_allocator>;
+
+    explicit JsonDocument(size_t initialCapacity = 4096, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : arena(std::make_unique<std::pmr::monotonic_buffer_resource>(initialCapacity, upstream))
+        , rootValue(allocator().new_object<Value>()) {}
+
+    // The tree lives in the arena, so it moves with it. A moved-from document
+    // has no root: it may only be assigned to or destroyed.
+    JsonDocument(JsonDocument&& other) noexcept
+        : arena(std::move(other.arena))
+        , rootValue(std::exchange(other.rootValue, nullptr))
+        , attachedFile(std::move(other.attachedFile)) {}
+
+    JsonDocument& operator=(JsonDocument&& other) noexcept {
+        if (this != &other) {
+            arena = std::move(other.arena);
+            rootValue = std::exchange(other.rootValue, nullptr);
+            attachedFile = std::move(other.attachedFile);
+        }
+        return *this;
+    }
+
+    // Precondition: the document has not been moved from.
+    const Value& root() const {
+        return *rootValue;
+    }
+    Value& root() {
+        return *rootValue;
+    }
+
+    std::pmr::polymorphic_allocator<char> allocator() const {
+        return arena.get();
+    }
+
+    // Keeps file alive as long as the document, so strings may borrow from it.
+    void attach(JsonMappedFile&& file) {
+        attachedFile = std::move(file);
+    }
+
+    const JsonMappedFile& attached() const {
+        return attachedFile;
+    }
+
+private:
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+    Value* rootValue;
+    JsonMappedFile attachedFile;
+};
+
+// Word tags of a JsonTape, stored in the top byte of each 64-bit word.
+enum class JsonTapeType : uint8_t {
+    Null = 'n',
+    True = 't',
+    False = 'f',
+    Int = 'i', // value in the low 32 bits
+    Int64 = 'l', // value in the next word
+    UInt64 = 'u', // value in the next word
+    Double = 'd', // value in the next word
+    RawNumber = 'r', // offset of the text in the string buffer
+    String = '"', // offset in the string buffer
+    StartArray = '[', // element count in bits 32-55, index past the matching end in bits 0-31
+    EndArray = ']', // index of the matching start
+    StartObject = '{', // member count in bits 32-55, index past the matching end in bits 0-31
+    EndObject = '}', // index of the matching start; members are a key string followed by the value
+};
+
+// Read-only handle to a value on a JsonTape, with the isX/toX vocabulary of
+// JsonValue. Valid while the tape is alive; moving the tape does not move its
+// buffers, so views survive that too.
+class JsonTapeView {
+public:
+    static constexpr uint32_t kCountSaturated = 0xFFFFFF;
+
+    constexpr JsonTapeType type() const {
+        return static_cast<JsonTapeType>(words[index] >> 56);
+    }
+
+    constexpr bool isNull() const {
+        return type() == JsonTapeType::Null;
+    }
+
+    constexpr bool isBool() const {
+        return type() == JsonTapeType::True || type() == JsonTapeType::False;
+    }
+
+    constexpr bool isInt() const {
+        return type() == JsonTapeType::Int;
+    }
+
+    constexpr bool isInt64() const {
+        return type() == JsonTapeType::Int64;
+    }
+
+    constexpr bool isUInt64() const {
+        return type() == JsonTapeType::UInt64;
+    }
+
+    constexpr bool isDouble() const {
+        return type() == JsonTapeType::Double;
+    }
+
+    constexpr bool isRawNumber() const {
+        return type() == JsonTapeType::RawNumber;
+    }
+
+    constexpr bool isString() const {
+        return type() == JsonTapeType::String;
+    }
+
+    constexpr bool isArray() const {
+        return type() == JsonTapeType::StartArray;
+    }
+
+    constexpr bool isObject() const {
+        return type() == JsonTapeType::StartObject;
+    }
+
+    constexpr bool toBool() const {
+        if (!isBool())
+            throw std::runtime_error("Value is not a boolean");
+        return type() == JsonTapeType::True;
+    }
+
+    constexpr int toInt() const {
+        if (!isInt())
+            throw std::runtime_error("Value is not an integer");
+        return static_cast<int32_t>(static_cast<uint32_t>(words[index]));
+    }
+
+    // Like JsonValue, these accept whichever integer type fits.
+    constexpr int64_t toInt64() const {
+        if (isInt())
+            return toInt();
+        if (isInt64() || (isUInt64() && words[index + 1] <= uint64_t(INT64_MAX)))
+            return static_cast<int64_t>(words[index + 1]);
+        throw std::runtime_error("Value is not a 64-bit integer");
+    }
+
+    constexpr uint64_t toUInt64() const {
+        if (isUInt64() || (isInt64() && static_cast<int64_t>(words[index + 1]) >= 0))
+            return words[index + 1];
+        if (isInt() && toInt() >= 0)
+            return static_cast<uint64_t>(toInt());
+        throw std::runtime_error("Value is not an unsigned 64-bit integer");
+    }
+
+    constexpr double toDouble() const {
+        if (!isDouble())
+            throw std::runtime_error("Value is not a double");
+        return std::bit_cast<double>(words[index + 1]);
+    }
+
+    constexpr std::string_view toString() const {
+        if (!isString())
+            throw std::runtime_error("Value is not a string");
+        return text();
+    }
+
+    constexpr std::string_view toRawNumber() const {
+        if (!isRawNumber())
+            throw std::runtime_error("Value is not a raw number");
+        return text();
+    }
+
+    // Number of elements or members.
+    constexpr size_t size() const {
+        if (!isArray() && !isObject())
+            throw std::runtime_error("Value is not an array or object");
+        const uint32_t count = (words[index] >> 32) & kCountSaturated;
+        if (count < kCountSaturated)
+            return count;
+        size_t n = 0;
+        for (size_t i = index + 1; i != end() - 1; i = skip(isObject() ? i + 1 : i))
+            ++n;
+        return n;
+    }
+
+    constexpr JsonTapeView operator[](size_t position) const {
+        if (!isArray())
+            throw std::runtime_error("Value is not an array");
+        size_t i = index + 1;
+        for (; i != end() - 1 && position; --position)
+            i = skip(i);
+        if (i == end() - 1)
+            throw std::runtime_error("Index out of range");
+        return { words, strings, i };
+    }
+
+    constexpr JsonTapeView operator[](std::string_view key) const {
+        if (const auto value = find(key))
+            return *value;
+        throw std::runtime_error("Key not found: " + std::string(key));
+    }
+
+    // Keys are compared in order; the tape has no index for wide objects.
+    constexpr std::optional<JsonTapeView> find(std::string_view key) const {
+        if (!isObject())
+            throw std::runtime_error("Value is not an object");
+        for (size_t i = index + 1; i != end() - 1; i = skip(i + 1)) {
+            if (JsonTapeView { words, strings, i }.text() == key)
+                return JsonTapeView { words, strings, i + 1 };
+        }
+        return std::nullopt;
+    }
+
+    // Calls callback(JsonTapeView) for every element.
+    template <typename Callback>
+    constexpr void forEachElement(Callback&& callback) const {
+        if (!isArray())
+            throw std::runtime_error("Value is not an array");
+        for (size_t i = index + 1; i != end() - 1; i = skip(i))
+            callback(JsonTapeView { words, strings, i });
+    }
+
+    // Calls callback(std::string_view key, JsonTapeView) for every member.
+    template <typename Callback>
+    constexpr void forEachMember(Callback&& callback) const {
+        if (!isObject())
+            throw std::runtime_error("Value is not an object");
+        for (size_t i = index + 1; i != end() - 1; i = skip(i + 1))
+            callback(JsonTapeView { words, strings, i }.text(), JsonTapeView { words, strings, i + 1 });
+    }
+
+    // Copies this value and everything below it into a JsonValue tree.
+    JsonValue materialize() const {
+        switch (type()) {
+        case JsonTapeType::Null: return nullptr;
+        case JsonTapeType::True: return true;
+        case JsonTapeType::False: return false;
+        case JsonTapeType::Int: return toInt();
+        case JsonTapeType::Int64: return toInt64();
+        case JsonTapeType::UInt64: return toUInt64();
+        case JsonTapeType::Double: return toDouble();
+        case JsonTapeType::RawNumber: return JsonValue::RawNumber { std::string(text()) };
+        case JsonTapeType::String: return std::string(text());
+        case JsonTapeType::StartArray: {
+            JsonValue::Array arr;
+            arr.elements.reserve(size());
+            forEachElement([&](JsonTapeView element) { arr.elements.push_back(element.materialize()); });
+            return arr;
+        }
+        default: {
+            JsonValue::Object obj;
+            obj.members.reserve(size());
+            forEachMember([&](std::string_view key, JsonTapeView value) { obj.members.emplace_back(std::string(key), value.materialize()); });
+            return obj;
+        }
+        }
+    }
+
+private:
+    friend class JsonTape;
+    template <size_t Words, size_t Strings>
+    friend class JsonStaticTape;
+
+    constexpr JsonTapeView(const uint64_t* words, const char* strings, size_t index) : words(words), strings(strings), index(index) {}
+
+    // Index past the matching end word of a container.
+    constexpr size_t end() const {
+        return static_cast<uint32_t>(words[index]);
+    }
+
+    // Index of the value after the one at i.
+    constexpr size_t skip(size_t i) const {
+        switch (static_cast<JsonTapeType>(words[i] >> 56)) {
+        case JsonTapeType::StartArray:
+        case JsonTapeType::StartObject: return static_cast<uint32_t>(words[i]);
+        case JsonTapeType::Int64:
+        case JsonTapeType::UInt64:
+        case JsonTapeType::Double: return i + 2;
+        default: return i + 1;
+        }
+    }
+
+    // String buffer entries are a little-endian 32-bit length followed by the
+    // bytes, which static tapes store the same way.
+    constexpr std::string_view text() const {
+        const char* entry = strings + (words[index] & ((uint64_t(1) << 56) - 1));
+        uint32_t length = 0;
+        if (std::endian::native == std::endian::little && !std::is_constant_evaluated()) {
+            std::memcpy(&length, entry, sizeof(length));
+        } else {
+            for (size_t i = 0; i < sizeof(length); ++i)
+                length |= uint32_t(static_cast<uint8_t>(entry[i])) << (8 * i);
+        }
+        return { entry + sizeof(length), length };
+    }
+
+    const uint64_t* words;
+    const char* strings;
+    size_t index;
+};
+
+// A parsed document flattened into one contiguous array of 64-bit tagged words
+// (see JsonTapeType) and one buffer of string bytes. Containers record where
+// they end, so skipping a subtree is a single jump, and iterating a document
+// walks memory in order instead of chasing pointers between nodes. Build with
+// JsonParser::parseTape and read through root().
+class JsonTape {
+public:
+    constexpr JsonTapeView root() const {
+        if (words.empty())
+            throw std::runtime_error("Tape is empty");
+        return { words.data(), strings.data(), 0 };
+    }
+
+    // Bytes held by the word and string buffers.
+    size_t memoryUsage() const {
+        return words.capacity() * sizeof(uint64_t) + strings.capacity();
+    }
+
+private:
+    friend class JsonParser;
+
+    std::vector<uint64_t> words;
+    std::vector<char> strings;
+};
+
+// A JsonTape in arrays sized to fit, so that a constexpr variable can hold one
+// in read-only data. Build with JsonParser::parseStatic or the _json literal.
+template <size_t Words, size_t Strings>
+class JsonStaticTape {
+public:
+    constexpr JsonTapeView root() const {
+        return { words.data(), strings.data(), 0 };
+    }
+
+private:
+    friend class JsonParser;
+
+    std::array<uint64_t, Words> words {};
+    std::array<char, Strings> strings {};
+};
+
+// A string literal passed as a template argument.
+template <size_t N>
+struct JsonLiteral {
+    constexpr JsonLiteral(const char (&text)[N]) {
+        std::copy_n(text, N, chars);
+    }
+
+    constexpr std::string_view view() const {
+        return { chars, N - 1 };
+    }
+
+    char chars[N];
+};
+
+// Base for handlers passed to JsonParser::parseSax. Every event is a no-op, so
+// handlers only need to declare the ones they care about; calls are resolved at
+// compile time. String and key views are only valid during the call.
+struct JsonSaxHandler {
+    void onNull() {}
+    void onBool(bool) {}
+    void onInt(int) {}
+    void onInt64(int64_t) {}
+    void onUInt64(uint64_t) {}
+    void onDouble(double) {}
+    void onRawNumber(std::string_view) {}
+    void onString(std::string_view) {}
+    void onKey(std::string_view) {}
+    void onStartObject() {}
+    void onEndObject() {}
+    void onStartArray() {}
+    void onEndArray() {}
+};
+
+// Assembles a JsonValue from SAX events, for event sources such as
+// JsonStreamParser that do not build trees themselves.
+class JsonDomHandler : public JsonSaxHandler {
+public:
+    void onNull() { add(nullptr); }
+    void onBool(bool b) { add(b); }
+    void onInt(int n) { add(n); }
+    void onInt64(int64_t n) { add(n); }
+    void onUInt64(uint64_t n) { add(n); }
+    void onDouble(double n) { add(n); }
+    void onRawNumber(std::string_view text) { add(JsonValue::RawNumber { std::string(text) }); }
+    void onString(std::string_view str) { add(str); }
+    void onKey(std::string_view key) { keys.emplace_back(key); }
+    void onStartObject() { stack.emplace_back(JsonValue::Object {}); }
+    void onEndObject() { close(); }
+    void onStartArray() { stack.emplace_back(JsonValue::Array {}); }
+    void onEndArray() { close(); }
+
+    // The completed root value
+    JsonValue& value() {
+        return root;
+    }
+
+private:
+    void add(JsonValue&& value) {
+        if (stack.empty()) {
+            root = std::move(value);
+        } else if (auto* arr = std::get_if<JsonValue::Array>(&stack.back().value)) {
+            arr->elements.emplace_back(std::move(value));
+        } else {
+            std::get<JsonValue::Object>(stack.back().value).members.emplace_back(std::move(keys.back()), std::move(value));
+            keys.pop_back();
+        }
+    }
+
+    void close() {
+        JsonValue value = std::move(stack.back());
+        stack.pop_back();
+        add(std::move(value));
+    }
+
+    std::vector<JsonValue> stack; // open containers
+    std::vector<std::string> keys; // keys awaiting their values
+    JsonValue root;
+};
+
+// Declares how a struct maps to a JSON object, for JsonParser::parseAs:
+//
+//     template <>
+//     struct JsonFields<Point> {
+//         static constexpr std::tuple fields { JsonField { "x", &Point::x }, JsonField { "y", &Point::y } };
+//     };
+template <typename T>
+struct JsonFields;
+
+template <typename T, typename Member>
+struct JsonField {
+    std::string_view name;
+    Member T::*member;
+};
+
+template <typename T, typename Member>
+JsonField(std::string_view, Member T::*) -> JsonField<T, Member>;
+
+// Perfect hash from the field names of T to their positions in
+// JsonFields<T>::fields, searched for at compile time: a key is looked up with
+// one hash, one table load and one comparison.
+template <typename T>
+struct JsonFieldTable {
+    static constexpr auto& fields = JsonFields<T>::fields;
+    static constexpr size_t kCount = std::tuple_size_v<std::remove_cvref_t<decltype(fields)>>;
+    static constexpr size_t kCapacity = std::bit_ceil(kCount * 8 + 1);
+
+    struct Table {
+        bool perfect = false;
+        unsigned shift = 0;
+        size_t mask = 0;
+        std::array<uint16_t, kCapacity> slots {}; // field position + 1, or 0
+        std::array<std::string_view, kCount> names {};
+    };
+
+    // Tries the smallest tables first, each with every window of hash bits.
+    static constexpr Table build() {
+        Table table;
+        table.names = std::apply([](const auto&... field) { return std::array<std::string_view, kCount> { field.name... }; }, fields);
+        for (size_t capacity = std::bit_ceil(std::max<size_t>(kCount, 1)); capacity <= kCapacity; capacity *= 2) {
+            for (unsigned shift = 0; shift + std::bit_width(capacity) <= 64; ++shift) {
+                table.slots = {};
+                bool perfect = true;
+                for (size_t i = 0; i < kCount && perfect; ++i) {
+                    uint16_t& slot = table.slots[(JsonValue::Object::hashKey(table.names[i]) >> shift) & (capacity - 1)];
+                    perfect = slot == 0;
+                    slot = static_cast<uint16_t>(i + 1);
+                }
+                if (perfect) {
+                    table.perfect = true;
+                    table.shift = shift;
+                    table.mask = capacity - 1;
+                    return table;
+                }
+            }
+        }
+        return table;
+    }
+
+    static constexpr bool unique() {
+        const auto names = std::apply([](const auto&... field) { return std::array<std::string_view, kCount> { field.name... }; }, fields);
+        for (size_t i = 0; i < kCount; ++i) {
+            for (size_t j = i + 1; j < kCount; ++j) {
+                if (names[i] == names[j])
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(unique(), "JsonFields names must be unique");
+    static constexpr Table table = unique() ? build() : Table {};
+    static_assert(!unique() || table.perfect, "No perfect hash found for these JsonFields names, though they are unique");
+
+    // Position of the field named key, or kCount.
+    static constexpr size_t find(std::string_view key) {
+        const uint16_t slot = table.slots[(JsonValue::Object::hashKey(key) >> table.shift) & table.mask];
+        return slot != 0 && table.names[slot - 1] == key ? slot - 1 : kCount;
+    }
+};
+
+// Containers parseAs reads besides JsonFields structs.
+template <typename T>
+inline constexpr bool kIsJsonVector = false;
+template <typename T, typename A>
+inline constexpr bool kIsJsonVector<std::vector<T, A>> = true;
+
+template <typename T>
+inline constexpr bool kIsJsonOptional = false;
+template <typename T>
+inline constexpr bool kIsJsonOptional<std::optional<T>> = true;
+
+template <typename T>
+inline constexpr bool kIsJsonMap = false;
+template <typename T, typename C, typename A>
+inline constexpr bool kIsJsonMap<std::map<std::string, T, C, A>> = true;
+
+template <typename Handler>
+class JsonStreamParser;
+
+class JsonLinesParser;
+class JsonLazyValue;
+class JsonPath;
+
+class JsonParser {
+public:
+    constexpr JsonParser() noexcept = default;
+    constexpr ~JsonParser() noexcept = default;
+    constexpr JsonParser(const JsonParser& other) noexcept = default;
+    constexpr JsonParser& operator=(const JsonParser& other) noexcept = default;
+    constexpr JsonParser(JsonParser&& other) noexcept = default;
+    constexpr JsonParser& operator=(JsonParser&& other) noexcept = default;
+
+    static constexpr JsonValue parse(std::string_view json, const JsonParseOptions& options = {}) {
+        return tryParse(json, options).value();
+    }
+
+    // Like parse, but reports malformed input through the result instead of
+    // throwing, so rejecting it costs no more than parsing it.
+    static constexpr JsonResult<JsonValue> tryParse(std::string_view json, const JsonParseOptions& options = {}) {
+        TextCursor in { json, 0, options.maxDepth };
+        skipWhitespace(json, in.pos);
+        DomBuilder<JsonValue> builder { {}, options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        JsonValue value = parseValue(in, builder);
+        endRoot(in);
+        if (in.failed())
+            return JsonError::at(json, in.pos, in.error);
+        return value;
+    }
+
+    // Parses into a JsonDocument, allocating the whole tree from its arena.
+    static JsonDocument parseDocument(std::string_view json, const JsonParseOptions& options = {}) {
+        return tryParseDocument(json, options).value();
+    }
+
+    static JsonResult<JsonDocument> tryParseDocument(std::string_view json, const JsonParseOptions& options = {}) {
+        JsonDocument doc(std::max<size_t>(json.size() * (options.borrowStrings ? 1 : 2), 4096));
+        if (const JsonError error = tryParseDocument(json, doc, options))
+            return error;
+        return doc;
+    }
+
+    // Parses the file at path without copying it: the file is memory-mapped and
+    // attached to the document, and by default strings without escapes borrow
+    // from the mapping.
+    static JsonDocument parseFile(const std::string& path, const JsonParseOptions& options = { .borrowStrings = true }) {
+        auto result = tryParseFile(path, options);
+        if (result.error().code == JsonErrorCode::FileError)
+            throw std::runtime_error("Could not read JSON file: " + path);
+        return std::move(result).value();
+    }
+
+    static JsonResult<JsonDocument> tryParseFile(const std::string& path, const JsonParseOptions& options = { .borrowStrings = true }) {
+        JsonMappedFile file;
+        if (!file.open(path.c_str()))
+            return JsonError { JsonErrorCode::FileError };
+        const std::string_view json = file.data();
+        JsonDocument doc(std::max<size_t>(json.size() * (options.borrowStrings ? 1 : 2), 4096));
+        doc.attach(std::move(file));
+        if (const JsonError error = tryParseDocument(json, doc, options))
+            return error;
+        return doc;
+    }
+
+    // Replaces the root of doc. The previous tree's memory is only reclaimed
+    // when the document is destroyed.
+    static void parseDocument(std::string_view json, JsonDocument& doc, const JsonParseOptions& options = {}) {
+        if (const JsonError error = tryParseDocument(json, doc, options))
+            throw std::runtime_error(error.message());
+    }
+
+    // On failure the root of doc is left unchanged.
+    static JsonError tryParseDocument(std::string_view json, JsonDocument& doc, const JsonParseOptions& options = {}) {
+        TextCursor in { json, 0, options.maxDepth };
+        skipWhitespace(json, in.pos);
+        DomBuilder<JsonDocument::Value> builder { doc.allocator(), options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        JsonDocument::Value value = parseValue(in, builder);
+        endRoot(in);
+        if (in.failed())
+            return JsonError::at(json, in.pos, in.error);
+        doc.root() = std::move(value);
+        return {};
+    }
+
+    // Replaces target with the parsed value, refilling the arrays, objects and
+    // strings it already holds instead of allocating new ones. Parsing a stream
+    // of similarly shaped documents into the same value allocates only when a
+    // document is larger than all before it.
+    static void parseInto(std::string_view json, JsonValue& target, const JsonParseOptions& options = {}) {
+        if (const JsonError error = tryParseInto(json, target, options))
+            throw std::runtime_error(error.message());
+    }
+
+    // On failure target is left valid but unspecified.
+    static JsonError tryParseInto(std::string_view json, JsonValue& target, const JsonParseOptions& options = {}) {
+        TextCursor in { json, 0, options.maxDepth };
+        skipWhitespace(json, in.pos);
+        ReuseBuilder builder { { {}, options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates }, &target };
+        JsonValue value = parseValue(in, builder);
+        endRoot(in);
+        if (in.failed())
+            return JsonError::at(json, in.pos, in.error);
+        target = std::move(value);
+        return {};
+    }
+
+    // Parses into the flat representation of JsonTape.
+    static constexpr JsonTape parseTape(std::string_view json, const JsonParseOptions& options = {}) {
+        return tryParseTape(json, options).value();
+    }
+
+    static constexpr JsonResult<JsonTape> tryParseTape(std::string_view json, const JsonParseOptions& options = {}) {
+        // Every input byte produces at most two words, whose end indexes are 32-bit
+        if (json.size() >= UINT32_MAX / 2)
+            return JsonError::at(json, 0, JsonErrorCode::InputTooLarge);
+        JsonTape tape;
+        tape.words.reserve(json.size() / 4 + 2);
+        tape.strings.reserve(json.size() / 2);
+        TextCursor in { json, 0, options.maxDepth };
+        skipWhitespace(json, in.pos);
+        TapeBuilder builder { tape, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        parseValue(in, builder);
+        endRoot(in);
+        if (in.failed())
+            return JsonError::at(json, in.pos, in.error);
+        return tape;
+    }
+
+    // Parses Text at compile time, so that
+    //     static constexpr auto config = JsonParser::parseStatic<R"({"retries": 3})">();
+    // costs nothing at startup. Invalid JSON fails to compile, and so do
+    // numbers the fast paths of parseNumber can't convert exactly. Literals
+    // beyond some tens of kilobytes run into the compiler's constant
+    // evaluation limit (-fconstexpr-ops-limit in GCC, -fconstexpr-steps in
+    // Clang).
+    template <JsonLiteral Text, JsonParseOptions Options = JsonParseOptions {}>
+    static consteval auto parseStatic() {
+        // Constant evaluation can't keep the vectors of a JsonTape, so it is
+        // copied out into arrays big enough for any input of this size, and
+        // from those into ones that fit. There are at most as many words as
+        // input bytes: values take one word, except doubles and 64-bit
+        // integers, which take two but are at least two bytes long. Strings
+        // take at most two bytes of the string buffer per input byte, as
+        // they have two quotes.
+        constexpr size_t kSize = Text.view().size();
+        constexpr auto bounded = [] {
+            const JsonTape tape = parseTape(Text.view(), Options);
+            struct {
+                std::array<uint64_t, kSize> words {};
+                std::array<char, 2 * kSize> strings {};
+                size_t wordCount, stringCount;
+            } out { {}, {}, tape.words.size(), tape.strings.size() };
+            std::copy(tape.words.begin(), tape.words.end(), out.words.begin());
+            std::copy(tape.strings.begin(), tape.strings.end(), out.strings.begin());
+            return out;
+        }();
+        JsonStaticTape<bounded.wordCount, bounded.stringCount> result;
+        std::copy_n(bounded.words.begin(), bounded.wordCount, result.words.begin());
+        std::copy_n(bounded.strings.begin(), bounded.stringCount, result.strings.begin());
+        return result;
+    }
+
+    // Parses straight into T without building a tree. T may be bool, an
+    // arithmetic type, std::string, JsonValue, a struct described by
+    // JsonFields, or a std::vector, std::optional or std::map with string keys
+    // of those. Unknown keys are skipped and missing ones leave their member
+    // as it was; null only matches std::optional and JsonValue. Vectors, maps
+    // and structs count towards options.maxDepth like arrays and objects.
+    template <typename T>
+    static T parseAs(std::string_view json, const JsonParseOptions& options = {}) {
+        return tryParseAs<T>(json, options).value();
+    }
+
+    template <typename T>
+    static JsonResult<T> tryParseAs(std::string_view json, const JsonParseOptions& options = {}) {
+        TypedCursor in { { json, 0, options.maxDepth }, options };
+        skipWhitespace(json, in.pos);
+        T out {};
+        parseTyped(in, out);
+        endRoot(in);
+        if (in.failed())
+            return JsonError::at(json, in.pos, in.error);
+        return out;
+    }
+
+    // Decodes a value encoded by JsonWriter::dumpBinary, or by any CBOR or
+    // MessagePack encoder, through the same tree building as parse. Byte
+    // strings, extension types and non-string keys have no JSON form and are
+    // rejected as InvalidBinary; CBOR tags other than bignums are ignored.
+    // Errors have an offset but no line or column.
+    static JsonValue parseBinary(std::string_view bytes, JsonBinaryFormat format, const JsonParseOptions& options = {}) {
+        return tryParseBinary(bytes, format, options).value();
+    }
+
+    static JsonResult<JsonValue> tryParseBinary(std::string_view bytes, JsonBinaryFormat format, const JsonParseOptions& options = {}) {
+        DomBuilder<JsonValue> builder { {}, options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        return parseBinaryValue(bytes, format, builder, options.maxDepth);
+    }
+
+    static JsonDocument parseBinaryDocument(std::string_view bytes, JsonBinaryFormat format, const JsonParseOptions& options = {}) {
+        return tryParseBinaryDocument(bytes, format, options).value();
+    }
+
+    static JsonResult<JsonDocument> tryParseBinaryDocument(std::string_view bytes, JsonBinaryFormat format, const JsonParseOptions& options = {}) {
+        JsonDocument doc(std::max<size_t>(bytes.size() * 2, 4096));
+        DomBuilder<JsonDocument::Value> builder { doc.allocator(), options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        auto result = parseBinaryValue(bytes, format, builder, options.maxDepth);
+        if (!result)
+            return result.error();
+        doc.root() = std::move(*result);
+        return doc;
+    }
+
+    // Streams the document to handler as events without building a tree.
+    template <typename Handler>
+    static void parseSax(std::string_view json, Handler& handler, const JsonParseOptions& options = {}) {
+        if (const JsonError error = tryParseSax(json, handler, options))
+            throw std::runtime_error(error.message());
+    }
+
+    // No events follow the one preceding an error.
+    template <typename Handler>
+    static JsonError tryParseSax(std::string_view json, Handler& handler, const JsonParseOptions& options = {}) {
+        TextCursor in { json, 0, options.maxDepth };
+        skipWhitespace(json, in.pos);
+        SaxBuilder<Handler> builder { handler, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        parseValue(in, builder);
+        endRoot(in);
+        if (in.failed())
+            return JsonError::at(json, in.pos, in.error);
+        return {};
+    }
+
+    // Two-stage parse: a vectorized pass locates every token, then the tree is
+    // built by walking the token positions instead of the raw bytes.
+    static JsonValue parseIndexed(std::string_view json, const JsonParseOptions& options = {}) {
+        return tryParseIndexed(json, options).value();
+    }
+
+    static JsonResult<JsonValue> tryParseIndexed(std::string_view json, const JsonParseOptions& options = {}) {
+        // Token positions are 32-bit
+        if (json.size() >= UINT32_MAX)
+            return JsonError::at(json, 0, JsonErrorCode::InputTooLarge);
+        return tryParseIndexed(json, JsonStructuralIndex::build(json), options);
+    }
+
+    // With an index built from json beforehand.
+    static JsonValue parseIndexed(std::string_view json, const JsonStructuralIndex& index, const JsonParseOptions& options = {}) {
+        return tryParseIndexed(json, index, options).value();
+    }
+
+    static JsonResult<JsonValue> tryParseIndexed(std::string_view json, const JsonStructuralIndex& index, const JsonParseOptions& options = {}) {
+        IndexCursor in { json, index.positions.data(), index.positions.front(), options.maxDepth };
+        DomBuilder<JsonValue> builder { {}, options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        JsonValue value = parseValue(in, builder);
+        endRoot(in);
+        if (in.failed())
+            return JsonError::at(json, in.pos, in.error);
+        return value;
+    }
+
+private:
+    template <typename Handler>
+    friend class JsonStreamParser;
+    friend class JsonLinesParser;
+    friend class JsonLazyValue;
+    friend class JsonPath;
+
+    // Walks the input byte by byte, skipping whitespace after every token.
+    // The first error is recorded with pos left at its offset; the grammar then
+    // returns without consuming anything more.
+    struct TextCursor {
+        std::string_view json;
+        size_t pos;
+        size_t maxDepth = JsonParseOptions {}.maxDepth;
+        JsonErrorCode error = JsonErrorCode::None;
+
+        constexpr char peek() {
+            return JsonParser::peek(json, pos, error);
+        }
+
+        constexpr void advance() {
+            ++pos;
+            skipWhitespace(json, pos);
+        }
+
+        constexpr void endScalar() {
+            skipWhitespace(json, pos);
+        }
+
+        constexpr bool failed() const {
+            return error != JsonErrorCode::None;
+        }
+
+        constexpr void fail(JsonErrorCode code) {
+            if (!failed())
+                error = code;
+        }
+    };
+
+    // A TextCursor for parseTyped, which recurses through the containers of T
+    // and so counts their depth itself.
+    struct TypedCursor : TextCursor {
+        const JsonParseOptions& options;
+        size_t depth = 0;
+    };
+
+    // Walks the token positions of a JsonStructuralIndex.
+    struct IndexCursor {
+        std::string_view json;
+        const uint32_t* token;
+        size_t pos;
+        size_t maxDepth = JsonParseOptions {}.maxDepth;
+        JsonErrorCode error = JsonErrorCode::None;
+
+        constexpr char peek() {
+            return JsonParser::peek(json, pos, error);
+        }
+
+        constexpr void advance() {
+            pos = *++token;
+        }
+
+        // A scalar must run up to whitespace or the next token
+        constexpr void endScalar() {
+            if (pos < json.size() && pos != token[1] && !isspace(json[pos]))
+                return fail(JsonErrorCode::UnexpectedCharacter);
+            pos = *++token;
+        }
+
+        constexpr bool failed() const {
+            return error != JsonErrorCode::None;
+        }
+
+        constexpr void fail(JsonErrorCode code) {
+            if (!failed())
+                error = code;
+        }
+    };
+
+    // Builds a tree of Json nodes. Containers are allocated with alloc, and so are
+    // the bytes of std::string_view strings, which are never freed individually;
+    // view strings therefore need an arena-style allocator.
+    template <typename Json>
+    struct DomBuilder {
+        using Value = Json;
+        using String = typename Json::StringType;
+        using Array = typename Json::Array;
+        using Object = typename Json::Object;
+
+        static constexpr bool kViewStrings = std::is_same_v<String, std::string_view>;
+        static_assert(!kViewStrings || !std::is_same_v<typename Json::template AllocatorType<char>, std::allocator<char>>,
+            "std::string_view strings require an arena allocator");
+
+        typename Json::template AllocatorType<char> alloc;
+        bool borrowStrings = false; // view strings without escapes point into the input
+        bool indexObjects = false; // build key indexes of wide objects eagerly
+        bool rawBigIntegers = false; // keep integers beyond 64 bits as RawNumber
+        bool validateUtf8 = true; // reject strings that are not UTF-8
+        bool replaceLoneSurrogates = false; // decode unpaired surrogates to U+FFFD
+
+        constexpr Value null() const {
+            return nullptr;
+        }
+
+        constexpr Value boolean(bool b) const {
+            return b;
+        }
+
+        template <typename Number>
+        constexpr Value number(Number n) const {
+            return n;
+        }
+
+        constexpr Value rawNumber(std::string_view text, bool inInput = true) {
+            return typename Json::RawNumber { string(text, inInput) };
+        }
+
+        // An already decoded string, which may only be borrowed if it lies in
+        // the parsed input.
+        constexpr String string(std::string_view str, bool inInput) {
+            if constexpr (kViewStrings) {
+                if (borrowStrings && inInput)
+                    return str;
+                char* data = alloc.allocate(str.size());
+                std::copy(str.begin(), str.end(), data);
+                return { data, str.size() };
+            } else {
+                return String(str);
+            }
+        }
+
+        constexpr String key(std::string_view str, bool inInput) {
+            return string(str, inInput);
+        }
+
+        constexpr String string(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            bool escaped = false, nonAscii = false;
+            const size_t end = findStringEnd(json, pos, escaped, nonAscii);
+            if (validateUtf8 && nonAscii && !validateString(json, pos, end, error))
+                return {};
+            if (!escaped && end < json.size()) {
+                const auto str = json.substr(pos + 1, end - pos - 1);
+                pos = end + 1;
+                return string(str, true);
+            }
+            if constexpr (kViewStrings) {
+                CharBuffer out { alloc.allocate(end - pos), 0 };
+                parseString(json.substr(0, end + 1), pos, out, error, replaceLoneSurrogates);
+                return { out.data, out.size };
+            } else {
+                String str;
+                str.reserve(end - pos - 1); // escapes only shrink
+                parseString(json, pos, str, error, replaceLoneSurrogates);
+                return str;
+            }
+        }
+
+        constexpr String key(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            return string(json, pos, error);
+        }
+
+        constexpr Array startArray() const {
+            return Array { decltype(Array::elements)(alloc) };
+        }
+
+        constexpr void element(Array& arr, Value&& value) const {
+            arr.elements.emplace_back(std::move(value));
+        }
+
+        constexpr Value endArray(Array&& arr) const {
+            return std::move(arr);
+        }
+
+        constexpr Object startObject() const {
+            return Object { decltype(Object::members)(alloc) };
+        }
+
+        // Capacity for containers whose size is known up front.
+        constexpr void reserve(Array& arr, size_t count) const {
+            arr.elements.reserve(count);
+        }
+
+        constexpr void reserve(Object& obj, size_t count) const {
+            obj.members.reserve(count);
+        }
+
+        constexpr void member(Object& obj, String&& key, Value&& value) const {
+            obj.members.emplace_back(std::move(key), std::move(value));
+        }
+
+        constexpr Value endObject(Object&& obj) const {
+            if (indexObjects && obj.members.size() >= Object::kIndexThreshold) {
+                obj.buildIndex();
+            }
+            return std::move(obj);
+        }
+    };
+
+    // Builds a JsonValue out of the storage of a previous one. Values are
+    // produced in document order, so next tracks the slot of the old tree that
+    // the next value replaces: containers and strings found there are taken
+    // over and refilled, and the tree only allocates where it grows.
+    struct ReuseBuilder : DomBuilder<JsonValue> {
+        using Base = DomBuilder<JsonValue>;
+        using Base::key;
+        using Base::string;
+
+        struct Array {
+            JsonValue::Array value;
+            size_t count = 0;
+        };
+
+        struct Object {
+            JsonValue::Object value;
+            size_t count = 0;
+        };
+
+        JsonValue* next = nullptr; // old value in the slot being parsed, if any
+        String* nextKey = nullptr; // old key of the member being parsed, if any
+
+        String string(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            String str = recycle(next);
+            const std::string_view decoded = readString(json, pos, str, validateUtf8, replaceLoneSurrogates, error);
+            if (decoded.data() != str.data())
+                str.assign(decoded);
+            return str;
+        }
+
+        String key(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            String str = nextKey ? std::move(*nextKey) : String();
+            const std::string_view decoded = readString(json, pos, str, validateUtf8, replaceLoneSurrogates, error);
+            if (decoded.data() != str.data())
+                str.assign(decoded);
+            return str;
+        }
+
+        Array startArray() {
+            Array arr;
+            if (next && next->isArray())
+                arr.value = std::move(next->asArray());
+            next = arr.value.elements.empty() ? nullptr : arr.value.elements.data();
+            return arr;
+        }
+
+        void element(Array& arr, Value&& value) {
+            auto& elements = arr.value.elements;
+            if (arr.count < elements.size())
+                elements[arr.count] = std::move(value);
+            else
+                elements.emplace_back(std::move(value));
+            ++arr.count;
+            next = arr.count < elements.size() ? &elements[arr.count] : nullptr;
+        }
+
+        Value endArray(Array&& arr) {
+            auto& elements = arr.value.elements;
+            elements.erase(elements.begin() + arr.count, elements.end());
+            return std::move(arr.value);
+        }
+
+        Object startObject() {
+            Object obj;
+            if (next && next->isObject())
+                obj.value = std::move(next->asObject());
+            seek(obj);
+            return obj;
+        }
+
+        void member(Object& obj, String&& key, Value&& value) {
+            auto& members = obj.value.members;
+            if (obj.count < members.size()) {
+                members[obj.count].first = std::move(key);
+                members[obj.count].second = std::move(value);
+            } else {
+                members.emplace_back(std::move(key), std::move(value));
+            }
+            ++obj.count;
+            seek(obj);
+        }
+
+        Value endObject(Object&& obj) {
+            auto& members = obj.value.members;
+            members.erase(members.begin() + obj.count, members.end());
+            obj.value.keyIndex.indexedSize = 0; // the keys may have changed
+            return Base::endObject(std::move(obj.value));
+        }
+
+    private:
+        // The string held by slot, emptied but with its capacity.
+        static String recycle(JsonValue* slot) {
+            String str;
+            if (slot && slot->isString())
+                str = std::move(slot->asString());
+            str.clear();
+            return str;
+        }
+
+        void seek(Object& obj) {
+            auto& members = obj.value.members;
+            const bool reused = obj.count < members.size();
+            nextKey = reused ? &members[obj.count].first : nullptr;
+            next = reused ? &members[obj.count].second : nullptr;
+        }
+    };
+
+    // Forwards values to a JsonSaxHandler-style handler instead of building them.
+    // Strings without escapes are passed as views into the input, others are
+    // decoded into a reused scratch buffer.
+    template <typename Handler>
+    struct SaxBuilder {
+        struct Value {};
+        using Array = Value;
+        using Object = Value;
+
+        Handler& handler;
+        bool rawBigIntegers = false;
+        bool validateUtf8 = true;
+        bool replaceLoneSurrogates = false;
+        std::string scratch {};
+
+        Value null() {
+            handler.onNull();
+            return {};
+        }
+
+        Value boolean(bool b) {
+            handler.onBool(b);
+            return {};
+        }
+
+        Value number(int n) {
+            handler.onInt(n);
+            return {};
+        }
+
+        Value number(int64_t n) {
+            handler.onInt64(n);
+            return {};
+        }
+
+        Value number(uint64_t n) {
+            handler.onUInt64(n);
+            return {};
+        }
+
+        Value rawNumber(std::string_view text) {
+            handler.onRawNumber(text);
+            return {};
+        }
+
+        Value number(double n) {
+            handler.onDouble(n);
+            return {};
+        }
+
+        Value string(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            const std::string_view str = decode(json, pos, error);
+            if (error == JsonErrorCode::None)
+                handler.onString(str);
+            return {};
+        }
+
+        Value key(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            const std::string_view str = decode(json, pos, error);
+            if (error == JsonErrorCode::None)
+                handler.onKey(str);
+            return {};
+        }
+
+        Array startArray() {
+            handler.onStartArray();
+            return {};
+        }
+
+        void element(Array&, Value&&) {}
+
+        Value endArray(Array&&) {
+            handler.onEndArray();
+            return {};
+        }
+
+        Object startObject() {
+            handler.onStartObject();
+            return {};
+        }
+
+        void member(Object&, Value&&, Value&&) {}
+
+        Value endObject(Object&&) {
+            handler.onEndObject();
+            return {};
+        }
+
+        std::string_view decode(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            return readString(json, pos, scratch, validateUtf8, replaceLoneSurrogates, error);
+        }
+    };
+
+    // Appends to a JsonTape. Containers hold the index of their start word and
+    // patch it with the count and end index once closed.
+    struct TapeBuilder {
+        struct Value {};
+        struct Array {
+            size_t start;
+            uint32_t count;
+        };
+        using Object = Array;
+
+        JsonTape& tape;
+        bool rawBigIntegers = false;
+        bool validateUtf8 = true;
+        bool replaceLoneSurrogates = false;
+
+        constexpr void append(JsonTapeType type, uint64_t payload) {
+            tape.words.push_back(uint64_t(type) << 56 | payload);
+        }
+
+        constexpr Value null() {
+            append(JsonTapeType::Null, 0);
+            return {};
+        }
+
+        constexpr Value boolean(bool b) {
+            append(b ? JsonTapeType::True : JsonTapeType::False, 0);
+            return {};
+        }
+
+        constexpr Value number(int n) {
+            append(JsonTapeType::Int, static_cast<uint32_t>(n));
+            return {};
+        }
+
+        constexpr Value number(int64_t n) {
+            append(JsonTapeType::Int64, 0);
+            tape.words.push_back(static_cast<uint64_t>(n));
+            return {};
+        }
+
+        constexpr Value number(uint64_t n) {
+            append(JsonTapeType::UInt64, 0);
+            tape.words.push_back(n);
+            return {};
+        }
+
+        constexpr Value number(double n) {
+            append(JsonTapeType::Double, 0);
+            tape.words.push_back(std::bit_cast<uint64_t>(n));
+            return {};
+        }
+
+        constexpr Value rawNumber(std::string_view text) {
+            const size_t offset = startText();
+            tape.strings.insert(tape.strings.end(), text.begin(), text.end());
+            endText(offset);
+            append(JsonTapeType::RawNumber, offset);
+            return {};
+        }
+
+        constexpr Value string(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            const size_t offset = startText();
+            bool escaped = false, nonAscii = false;
+            const size_t end = findStringEnd(json, pos, escaped, nonAscii);
+            if (validateUtf8 && nonAscii && !validateString(json, pos, end, error))
+                return {};
+            if (!escaped && end < json.size()) {
+                tape.strings.insert(tape.strings.end(), json.begin() + pos + 1, json.begin() + end);
+                pos = end + 1;
+            } else if (!parseString(json, pos, tape.strings, error, replaceLoneSurrogates)) {
+                return {};
+            }
+            endText(offset);
+            append(JsonTapeType::String, offset);
+            return {};
+        }
+
+        constexpr Value key(std::string_view json, size_t& pos, JsonErrorCode& error) {
+            return string(json, pos, error);
+        }
+
+        constexpr Array startArray() {
+            append(JsonTapeType::StartArray, 0);
+            return { tape.words.size() - 1, 0 };
+        }
+
+        constexpr void element(Array& arr, Value&&) {
+            ++arr.count;
+        }
+
+        constexpr Value endArray(Array&& arr) {
+            close(arr, JsonTapeType::StartArray, JsonTapeType::EndArray);
+            return {};
+        }
+
+        constexpr Object startObject() {
+            append(JsonTapeType::StartObject, 0);
+            return { tape.words.size() - 1, 0 };
+        }
+
+        constexpr void member(Object& obj, Value&&, Value&&) {
+            ++obj.count;
+        }
+
+        constexpr Value endObject(Object&& obj) {
+            close(obj, JsonTapeType::StartObject, JsonTapeType::EndObject);
+            return {};
+        }
+
+        constexpr void close(const Array& container, JsonTapeType start, JsonTapeType end) {
+            append(end, container.start);
+            const uint64_t count = std::min(container.count, JsonTapeView::kCountSaturated);
+            tape.words[container.start] = uint64_t(start) << 56 | count << 32 | tape.words.size();
+        }
+
+        // Reserves the length prefix of a string buffer entry.
+        constexpr size_t startText() {
+            const size_t offset = tape.strings.size();
+            tape.strings.resize(offset + sizeof(uint32_t));
+            return offset;
+        }
+
+        constexpr void endText(size_t offset) {
+            const uint32_t length = static_cast<uint32_t>(tape.strings.size() - offset - sizeof(uint32_t));
+            if (std::endian::native == std::endian::little && !std::is_constant_evaluated()) {
+                std::memcpy(tape.strings.data() + offset, &length, sizeof(length));
+            } else {
+                for (size_t i = 0; i < sizeof(length); ++i)
+                    tape.strings[offset + i] = static_cast<char>(length >> (8 * i));
+            }
+        }
+    };
+
+    // Captures a single number for parseTyped.
+    struct NumberBuilder {
+        using Value = std::variant<int64_t, uint64_t, double>;
+
+        bool rawBigIntegers = false;
+
+        Value number(int n) const {
+            return int64_t(n);
+        }
+
+        Value number(int64_t n) const {
+            return n;
+        }
+
+        Value number(uint64_t n) const {
+            return n;
+        }
+
+        Value number(double n) const {
+            return n;
+        }
+
+        Value rawNumber(std::string_view) const {
+            return {};
+        }
+    };
+
+    template <typename T>
+    static void parseTyped(TypedCursor& in, T& out) {
+        const char c = in.peek();
+        if (in.failed())
+            return;
+        if constexpr (kIsJsonOptional<T>) {
+            if (c == 'n') {
+                if (parseLiteral(in.json, in.pos, "null", JsonErrorCode::ExpectedNull, in.error))
+                    in.endScalar();
+                out.reset();
+            } else {
+                parseTyped(in, out.emplace());
+            }
+        } else if constexpr (std::is_same_v<T, JsonValue>) {
+            const JsonParseOptions& options = in.options;
+            DomBuilder<JsonValue> builder { {}, options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+            out = parseNested(in, builder);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            if (c == 't' && parseLiteral(in.json, in.pos, "true", JsonErrorCode::ExpectedTrue, in.error))
+                out = true;
+            else if (c == 'f' && parseLiteral(in.json, in.pos, "false", JsonErrorCode::ExpectedFalse, in.error))
+                out = false;
+            else
+                return in.fail(JsonErrorCode::UnexpectedType);
+            in.endScalar();
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            if (c != '-' && !isdigit(c))
+                return in.fail(JsonErrorCode::UnexpectedType);
+            NumberBuilder builder;
+            const auto number = parseNumber(in.json, in.pos, builder, in.error);
+            if (in.failed())
+                return;
+            const bool fits = std::visit(
+                [&](auto n) {
+                    if constexpr (std::is_floating_point_v<T>) {
+                        out = static_cast<T>(n);
+                        return true;
+                    } else if constexpr (std::is_integral_v<decltype(n)>) {
+                        out = static_cast<T>(n);
+                        return std::in_range<T>(n);
+                    } else {
+                        return false;
+                    }
+                },
+                number);
+            if (!fits)
+                return in.fail(JsonErrorCode::UnexpectedType);
+            in.endScalar();
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            if (c != '"')
+                return in.fail(JsonErrorCode::UnexpectedType);
+            const std::string_view str = readString(in.json, in.pos, out, in.options.validateUtf8, in.options.replaceLoneSurrogates, in.error);
+            if (!in.failed()) {
+                if (str.data() != out.data())
+                    out.assign(str);
+                in.endScalar();
+            }
+        } else if constexpr (kIsJsonVector<T>) {
+            if (c != '[')
+                return in.fail(JsonErrorCode::UnexpectedType);
+            out.clear();
+            parseTypedMembers(in, ']', JsonErrorCode::ExpectedCommaOrBracket, [&] { parseTyped(in, out.emplace_back()); });
+        } else if constexpr (kIsJsonMap<T>) {
+            if (c != '{')
+                return in.fail(JsonErrorCode::UnexpectedType);
+            out.clear();
+            std::string_view key;
+            std::string scratch;
+            parseTypedMembers(in, '}', JsonErrorCode::ExpectedCommaOrBrace, [&] {
+                if (parseTypedKey(in, key, scratch))
+                    parseTyped(in, out[std::string(key)]);
+            });
+        } else {
+            static_assert(requires { JsonFields<T>::fields; }, "parseAs needs a JsonFields specialization for this type");
+            if (c != '{')
+                return in.fail(JsonErrorCode::UnexpectedType);
+            std::string_view key;
+            std::string scratch;
+            parseTypedMembers(in, '}', JsonErrorCode::ExpectedCommaOrBrace, [&] {
+                if (parseTypedKey(in, key, scratch))
+                    parseTypedField(in, out, JsonFieldTable<T>::find(key), std::make_index_sequence<JsonFieldTable<T>::kCount>());
+            });
+        }
+    }
+
+    // Walks the elements or members of the container at in, calling
+    // parseElement with in at each one.
+    template <typename ParseElement>
+    static void parseTypedMembers(TypedCursor& in, char close, JsonErrorCode separatorError, ParseElement&& parseElement) {
+        if (in.depth >= in.maxDepth)
+            return in.fail(JsonErrorCode::DepthLimitExceeded);
+        ++in.depth;
+        in.advance(); // consume opening bracket
+        if (in.peek() != close) {
+            while (true) {
+                parseElement();
+                if (in.failed())
+                    return;
+                if (in.peek() == close)
+                    break;
+                if (in.peek() != ',')
+                    return in.fail(separatorError);
+                in.advance();
+                if (in.peek() == close)
+                    break; // Allow trailing comma
+            }
+        }
+        --in.depth;
+        in.advance(); // consume closing bracket
+    }
+
+    // parseValue at the current depth of in, so the limit covers both.
+    template <typename Builder>
+    static typename Builder::Value parseNested(TypedCursor& in, Builder& b) {
+        const size_t maxDepth = std::exchange(in.maxDepth, in.maxDepth - in.depth);
+        auto value = parseValue(in, b);
+        in.maxDepth = maxDepth;
+        return value;
+    }
+
+    // Reads a key and its colon, leaving in at the value. Keys without escapes
+    // are views of the input; others are decoded into scratch.
+    static bool parseTypedKey(TypedCursor& in, std::string_view& key, std::string& scratch) {
+        if (in.peek() != '"') {
+            in.fail(JsonErrorCode::ExpectedKey);
+            return false;
+        }
+        key = readString(in.json, in.pos, scratch, in.options.validateUtf8, in.options.replaceLoneSurrogates, in.error);
+        if (in.failed())
+            return false;
+        in.endScalar();
+        if (in.peek() != ':') {
+            in.fail(JsonErrorCode::ExpectedColon);
+            return false;
+        }
+        in.advance();
+        return true;
+    }
+
+    // Parses into the field at position, or skips the value of an unknown key.
+    template <typename T, size_t... I>
+    static void parseTypedField(TypedCursor& in, T& out, size_t position, std::index_sequence<I...>) {
+        constexpr auto& fields = JsonFields<T>::fields;
+        if (!((position == I && (parseTyped(in, out.*std::get<I>(fields).member), true)) || ...)) {
+            JsonSaxHandler skip;
+            SaxBuilder<JsonSaxHandler> builder { skip, false, in.options.validateUtf8, in.options.replaceLoneSurrogates };
+            parseNested(in, builder);
+        }
+    }
+
+    // Appends to a preallocated character buffer.
+    struct CharBuffer {
+        char* data;
+        size_t size;
+
+        constexpr void push_back(char c) {
+            data[size++] = c;
+        }
+
+        constexpr void append(const char* run, size_t n) {
+            std::copy(run, run + n, data + size);
+            size += n;
+        }
+    };
+
+    // Single spaces between tokens are the common case; longer runs such as
+    // indentation go to the vector kernel.
+    static constexpr void skipWhitespace(std::string_view json, size_t& pos) {
+        if (pos < json.size() && isspace(json[pos]))
+            ++pos;
+        if (pos < json.size() && isspace(json[pos])) {
+            if (std::is_constant_evaluated()) {
+                while (pos < json.size() && isspace(json[pos]))
+                    ++pos;
+            } else {
+                pos = JsonSimd::skipWhitespace(json.data() + pos + 1, json.data() + json.size()) - json.data();
+            }
+        }
+    }
+
+    // The character at pos, or '\0' and an UnexpectedEnd error past the end.
+    static constexpr char peek(std::string_view json, size_t pos, JsonErrorCode& error) {
+        if (pos < json.size())
+            return json[pos];
+        if (error == JsonErrorCode::None)
+            error = JsonErrorCode::UnexpectedEnd;
+        return '\0';
+    }
+
+    // The helpers below report malformed input by setting error and returning
+    // false or an empty value, leaving pos at the offending byte.
+
+    // Open containers are kept on stacks of their own rather than the call
+    // stack, so hostile nesting runs into in.maxDepth instead of a stack
+    // overflow. Each pass of the outer loop opens a container; the runs below
+    // then add its values until one is a container too, closing containers
+    // and adding them to their parents as they end.
+    template <typename Cursor, typename Builder>
+    static constexpr typename Builder::Value parseValue(Cursor& in, Builder& b) {
+        char c = in.peek();
+        if (c != '[' && c != '{') {
+            if (in.failed())
+                return {};
+            auto value = parseScalar(in.json, in.pos, b, in.error);
+            if (!in.failed())
+                in.endScalar();
+            return value;
+        }
+
+        // Each frame records whether the container around it is an array.
+        struct ArrayFrame {
+            typename Builder::Array arr;
+            bool inArray;
+        };
+        struct ObjectFrame {
+            typename Builder::Object obj;
+            decltype(b.key(in.json, in.pos, in.error)) key; // of the member being parsed
+            bool inArray;
+        };
+        std::vector<ArrayFrame> arrays;
+        std::vector<ObjectFrame> objects;
+        size_t depth = 0;
+        bool inArray = false; // whether the innermost open container is an array
+        while (true) {
+            if (depth >= in.maxDepth) {
+                in.fail(JsonErrorCode::DepthLimitExceeded);
+                return {};
+            }
+            ++depth;
+            if (c == '[') {
+                arrays.push_back({ b.startArray(), inArray });
+                inArray = true;
+            } else {
+                objects.push_back({ b.startObject(), {}, inArray });
+                inArray = false;
+            }
+            in.advance(); // consume opening bracket or brace
+
+            bool afterValue = false;
+            while (true) {
+                const Run run = inArray ? arrayRun(in, b, arrays.back().arr, afterValue, c)
+                                        : objectRun(in, b, objects.back().obj, objects.back().key, afterValue, c);
+                if (run == Run::Nested)
+                    break;
+                if (run == Run::Failed)
+                    return {};
+                in.advance(); // consume closing bracket or brace
+                if (inArray) {
+                    ArrayFrame& frame = arrays.back();
+                    auto closed = b.endArray(std::move(frame.arr));
+                    inArray = frame.inArray;
+                    arrays.pop_back();
+                    if (--depth == 0)
+                        return closed;
+                    addTo(b, inArray, arrays, objects, std::move(closed));
+                } else {
+                    ObjectFrame& frame = objects.back();
+                    auto closed = b.endObject(std::move(frame.obj));
+                    inArray = frame.inArray;
+                    objects.pop_back();
+                    if (--depth == 0)
+                        return closed;
+                    addTo(b, inArray, arrays, objects, std::move(closed));
+                }
+                afterValue = true;
+            }
+        }
+    }
+
+    // Fails with TrailingData at anything but whitespace after the root value,
+    // which the cursor has already skipped.
+    template <typename Cursor>
+    static constexpr void endRoot(Cursor& in) {
+        if (!in.failed() && in.pos != in.json.size())
+            in.fail(JsonErrorCode::TrailingData);
+    }
+
+    // How a run over the values of a container stopped: at a value that is a
+    // container itself, whose first character is left in c; at the end of
+    // the container, with the cursor on its closing bracket or brace; or at
+    // an error.
+    enum class Run : uint8_t {
+        Nested,
+        End,
+        Failed
+    };
+
+    // Adds the elements of arr, starting after the opening bracket or, if
+    // afterValue, after an element.
+    template <typename Cursor, typename Builder>
+    static constexpr Run arrayRun(Cursor& in, Builder& b, typename Builder::Array& arr, bool afterValue, char& c) {
+        while (true) {
+            if (afterValue) {
+                if (in.peek() == ',') {
+                    in.advance();
+                    if (in.peek() == ']')
+                        return Run::End; // Allow trailing comma
+                } else if (in.peek() == ']') {
+                    return Run::End;
+                } else {
+                    in.fail(JsonErrorCode::ExpectedCommaOrBracket);
+                    return Run::Failed;
+                }
+            } else if (in.peek() == ']') {
+                return Run::End;
+            }
+            c = in.peek();
+            if (c == '[' || c == '{')
+                return Run::Nested;
+            if (in.failed())
+                return Run::Failed;
+            auto value = parseScalar(in.json, in.pos, b, in.error);
+            if (in.failed())
+                return Run::Failed;
+            in.endScalar();
+            if (in.failed())
+                return Run::Failed;
+            b.element(arr, std::move(value));
+            afterValue = true;
+        }
+    }
+
+    // Adds the members of obj like arrayRun. The key of a member whose value
+    // is a container is left in key.
+    template <typename Cursor, typename Builder, typename Key>
+    static constexpr Run objectRun(Cursor& in, Builder& b, typename Builder::Object& obj, Key& key, bool afterValue, char& c) {
+        while (true) {
+            if (afterValue) {
+                if (in.peek() == ',') {
+                    in.advance();
+                    if (in.peek() == '}')
+                        return Run::End; // Allow trailing comma
+                } else if (in.peek() == '}') {
+                    return Run::End;
+                } else {
+                    in.fail(JsonErrorCode::ExpectedCommaOrBrace);
+                    return Run::Failed;
+                }
+            } else if (in.peek() == '}') {
+                return Run::End;
+            }
+            if (in.peek() != '"') {
+                in.fail(JsonErrorCode::ExpectedKey);
+                return Run::Failed;
+            }
+            auto name = b.key(in.json, in.pos, in.error);
+            if (in.failed())
+                return Run::Failed;
+            in.endScalar();
+            if (in.peek() != ':') {
+                in.fail(JsonErrorCode::ExpectedColon);
+                return Run::Failed;
+            }
+            in.advance();
+            c = in.peek();
+            if (c == '[' || c == '{') {
+                key = std::move(name);
+                return Run::Nested;
+            }
+            if (in.failed())
+                return Run::Failed;
+            auto value = parseScalar(in.json, in.pos, b, in.error);
+            if (in.failed())
+                return Run::Failed;
+            in.endScalar();
+            if (in.failed())
+                return Run::Failed;
+            b.member(obj, std::move(name), std::move(value));
+            afterValue = true;
+        }
+    }
+
+    // Adds a closed container to the innermost open one.
+    template <typename Builder, typename ArrayFrames, typename ObjectFrames>
+    static constexpr void addTo(Builder& b, bool inArray, ArrayFrames& arrays, ObjectFrames& objects, typename Builder::Value&& value) {
+        if (inArray) {
+            b.element(arrays.back().arr, std::move(value));
+        } else {
+            auto& frame = objects.back();
+            b.member(frame.obj, std::move(frame.key), std::move(value));
+        }
+    }
+
+    template <typename Builder>
+    static constexpr typename Builder::Value parseScalar(std::string_view json, size_t& pos, Builder& b, JsonErrorCode& error) {
+        switch (json[pos]) {
+        case 'n':
+            if (!parseLiteral(json, pos, "null", JsonErrorCode::ExpectedNull, error))
+                return {};
+            return b.null();
+        case 't':
+            if (!parseLiteral(json, pos, "true", JsonErrorCode::ExpectedTrue, error))
+                return {};
+            return b.boolean(true);
+        case 'f':
+            if (!parseLiteral(json, pos, "false", JsonErrorCode::ExpectedFalse, error))
+                return {};
+            return b.boolean(false);
+        case '"': return b.string(json, pos, error);
+        default: return parseNumber(json, pos, b, error);
+        }
+    }
+
+    static constexpr bool parseLiteral(std::string_view json, size_t& pos, std::string_view literal, JsonErrorCode code, JsonErrorCode& error) {
+        if (json.substr(pos, literal.size()) != literal) {
+            error = code;
+            return false;
+        }
+        pos += literal.size();
+        return true;
+    }
+
+    // Position of the closing quote of the string starting at pos, or the input
+    // size if it is unterminated. Sets escaped if the string has escape sequences.
+    static constexpr size_t findStringEnd(std::string_view json, size_t pos, bool& escaped) {
+        bool nonAscii = false;
+        return findStringEnd(json, pos, escaped, nonAscii);
+    }
+
+    // Also sets nonAscii if the string has bytes outside ASCII.
+    static constexpr size_t findStringEnd(std::string_view json, size_t pos, bool& escaped, bool& nonAscii) {
+        ++pos; // skip opening quote
+        while (pos < json.size()) {
+            if (std::is_constant_evaluated())
+                nonAscii |= static_cast<uint8_t>(json[pos]) >= 0x80;
+            else
+                pos = JsonSimd::findQuoteOrBackslash(json.data() + pos, json.data() + json.size(), nonAscii) - json.data();
+            if (pos >= json.size())
+                break;
+            if (json[pos] == '"')
+                return pos;
+            if (json[pos] == '\\') {
+                escaped = true;
+                ++pos;
+            }
+            ++pos;
+        }
+        return json.size();
+    }
+
+    // Checks that the bytes of the string from the quote at pos to end are
+    // UTF-8, moving pos to the first invalid byte if not. Only needed for
+    // strings findStringEnd saw non-ASCII bytes in, which are still in cache.
+    static constexpr bool validateString(std::string_view json, size_t& pos, size_t end, JsonErrorCode& error) {
+        const char* const begin = json.data() + pos + 1;
+        const char* const last = json.data() + end;
+        const char* const invalid = std::is_constant_evaluated() || last - begin < 32 ? JsonSimd::validateUtf8Scalar(begin, last) : JsonSimd::validateUtf8(begin, last);
+        if (invalid == last)
+            return true;
+        pos = invalid - json.data();
+        error = JsonErrorCode::InvalidUtf8;
+        return false;
+    }
+
+    // The string at pos as a view of the input if it has no escapes, or
+    // decoded into scratch. Checks UTF-8 first if validate is set.
+    static std::string_view readString(std::string_view json, size_t& pos, std::string& scratch, bool validate, bool replaceLoneSurrogates, JsonErrorCode& error) {
+        bool escaped = false, nonAscii = false;
+        const size_t end = findStringEnd(json, pos, escaped, nonAscii);
+        if (validate && nonAscii && !validateString(json, pos, end, error))
+            return {};
+        if (!escaped && end < json.size()) {
+            const auto str = json.substr(pos + 1, end - pos - 1);
+            pos = end + 1;
+            return str;
+        }
+        scratch.clear();
+        scratch.reserve(end - pos - 1);
+        parseString(json, pos, scratch, error, replaceLoneSurrogates);
+        return scratch;
+    }
+
+    template <typename Out>
+    static constexpr bool parseString(std::string_view json, size_t& pos, Out& str, JsonErrorCode& error, bool replaceLoneSurrogates = false) {
+        ++pos; // skip opening quote
+        while (true) {
+            const char c = peek(json, pos, error);
+            if (c == '"') {
+                ++pos; // consume closing quote
+                return true;
+            } else if (c == '\\') {
+                ++pos; // skip escape character
+                if (!parseEscape(json, pos, str, error, replaceLoneSurrogates))
+                    return false;
+            } else if (pos == json.size()) {
+                return false;
+            } else {
+                // Runs between escapes are often a byte or two, which are copied
+                // as they are scanned. Longer ones go to the kernel and are
+                // appended in one go.
+                const size_t scalarEnd = std::is_constant_evaluated() ? json.size() : std::min(json.size(), pos + 8);
+                do {
+                    str.push_back(json[pos]);
+                    ++pos;
+                } while (pos < scalarEnd && json[pos] != '"' && json[pos] != '\\');
+                if (pos == scalarEnd && pos < json.size()) {
+                    const size_t run = JsonSimd::findQuoteOrBackslash(json.data() + pos, json.data() + json.size()) - json.data();
+                    if constexpr (requires { str.append(json.data(), run); })
+                        str.append(json.data() + pos, run - pos);
+                    else
+                        str.insert(str.end(), json.begin() + pos, json.begin() + run);
+                    pos = run;
+                }
+            }
+        }
+    }
+
+    // Decodes the escape sequence following a backslash at pos. A \u escape for
+    // a high surrogate is combined with a low surrogate escape right after it;
+    // a surrogate without its partner fails with InvalidCodepoint at its
+    // backslash, or decodes to U+FFFD if replaceLoneSurrogates is set.
+    template <typename Out>
+    static constexpr bool parseEscape(std::string_view json, size_t& pos, Out& str, JsonErrorCode& error, bool replaceLoneSurrogates = false) {
+        const char c = peek(json, pos, error);
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            str.push_back(c);
+            ++pos;
+            return true;
+        case 'b': str.push_back('\b'); ++pos; return true;
+        case 'f': str.push_back('\f'); ++pos; return true;
+        case 'n': str.push_back('\n'); ++pos; return true;
+        case 'r': str.push_back('\r'); ++pos; return true;
+        case 't': str.push_back('\t'); ++pos; return true;
+        case 'u': {
+            const size_t start = pos - 1;
+            ++pos;
+            uint32_t codepoint = parseUnicodeEscape(json, pos, error);
+            if (error != JsonErrorCode::None)
+                return false;
+            if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+                int32_t low = -1;
+                if (codepoint <= 0xDBFF && json.size() - pos >= 6 && json[pos] == '\\' && json[pos + 1] == 'u')
+                    low = decodeHex4(json.data() + pos + 2);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    pos += 6;
+                } else if (replaceLoneSurrogates) {
+                    codepoint = 0xFFFD;
+                } else {
+                    pos = start;
+                    error = JsonErrorCode::InvalidCodepoint;
+                    return false;
+                }
+            }
+            encodeUTF8(str, codepoint);
+            return true;
+        }
+        default:
+            if (pos < json.size())
+                error = JsonErrorCode::InvalidEscape;
+            return false;
+        }
+    }
+
+    // The four hex digits at pos, failing with InvalidEscape at the first
+    // character that is not one.
+    static constexpr uint32_t parseUnicodeEscape(std::string_view json, size_t& pos, JsonErrorCode& error) {
+        if (json.size() - pos >= 4) {
+            const int32_t codepoint = decodeHex4(json.data() + pos);
+            if (codepoint >= 0) {
+                pos += 4;
+                return codepoint;
+            }
+        }
+        for (; pos < json.size() && kHexDigits[static_cast<uint8_t>(json[pos])] >= 0; ++pos) {}
+        error = pos < json.size() ? JsonErrorCode::InvalidEscape : JsonErrorCode::UnexpectedEnd;
+        return 0;
+    }
+
+    // Value of each byte as a hex digit, or -1.
+    static constexpr auto kHexDigits = [] {
+        std::array<int8_t, 256> digits {};
+        for (int c = 0; c < 256; ++c)
+            digits[c] = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        return digits;
+    }();
+
+    // Value of the four hex digits at p, or negative if any is not one. A -1
+    // digit sets every high bit, so one sign test covers all four.
+    static constexpr int32_t decodeHex4(const char* p) {
+        const auto digit = [&](int i) { return int32_t(kHexDigits[static_cast<uint8_t>(p[i])]); };
+        return digit(0) << 12 | digit(1) << 8 | digit(2) << 4 | digit(3);
+    }
+
+    // codepoint must be at most 0x10FFFF.
+    template <typename Out>
+    static constexpr void encodeUTF8(Out& str, uint32_t codepoint) {
+        if (codepoint <= 0x7F) {
+            str.push_back(static_cast<char>(codepoint));
+        } else if (codepoint <= 0x7FF) {
+            str.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        } else if (codepoint <= 0xFFFF) {
+            str.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+            str.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        } else {
+            str.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+            str.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    // Integers are accumulated in the same pass that scans them, eight digits at
+    // a time where possible, and built as the narrowest of int, int64_t and
+    // uint64_t that holds them. Larger ones become doubles, or RawNumbers if the
+    // builder keeps rawBigIntegers. In constant evaluation, numbers that would
+    // need std::from_chars fail with InvalidNumber.
+    template <typename Builder>
+    static constexpr typename Builder::Value parseNumber(std::string_view json, size_t& pos, Builder& b, JsonErrorCode& error) {
+        const char* const start = json.data() + pos;
+        const char* const end = json.data() + json.size();
+        const char* p = start;
+        const bool negative = p < end && *p == '-';
+        p += negative;
+
+        const char* const digits = p;
+        uint64_t magnitude = 0;
+        if (std::endian::native == std::endian::little && !std::is_constant_evaluated()) {
+            uint64_t chunk;
+            while (end - p >= 8 && (std::memcpy(&chunk, p, 8), isEightDigits(chunk))) {
+                magnitude = magnitude * 100000000 + parseEightDigits(chunk);
+                p += 8;
+            }
+        }
+        while (p < end && isdigit(*p)) {
+            magnitude = magnitude * 10 + (*p - '0');
+            ++p;
+        }
+
+        if (p < end && (*p == '.' || *p == 'e' || *p == 'E'))
+            return parseDouble(json, pos, digits, p, magnitude, negative, b, error);
+        if (p == digits) {
+            error = JsonErrorCode::InvalidNumber;
+            return {};
+        }
+        pos += p - start;
+
+        // Up to 19 digits always fit; beyond that magnitude may have wrapped
+        bool fits = p - digits <= 19;
+        if (!fits && !std::is_constant_evaluated())
+            fits = std::from_chars(digits, p, magnitude).ec == std::errc();
+        if (fits && (!negative || magnitude <= 9223372036854775808u))
+            return integer(b, magnitude, negative);
+
+        if (b.rawBigIntegers)
+            return b.rawNumber({ start, static_cast<size_t>(p - start) });
+        if (std::is_constant_evaluated()) {
+            error = JsonErrorCode::InvalidNumber;
+            return {};
+        }
+        double num;
+        std::from_chars(start, p, num);
+        return b.number(num);
+    }
+
+    // The narrowest of int, int64_t and uint64_t holding the integer. A negative
+    // magnitude must be at most 2^63.
+    template <typename Builder>
+    static constexpr typename Builder::Value integer(Builder& b, uint64_t magnitude, bool negative) {
+        if (negative) {
+            if (magnitude <= 2147483648u)
+                return b.number(static_cast<int>(0 - magnitude));
+            return b.number(static_cast<int64_t>(0 - magnitude));
+        }
+        if (magnitude <= 2147483647u)
+            return b.number(static_cast<int>(magnitude));
+        if (magnitude <= 9223372036854775807u)
+            return b.number(static_cast<int64_t>(magnitude));
+        return b.number(magnitude);
+    }
+
+    // Finishes a number with a fraction or exponent. Its integer part runs from
+    // digits to p with value magnitude, which the fraction digits go on to
+    // accumulate into. Inputs the fast paths can't convert, including every
+    // malformed or out of range one, go to std::from_chars.
+    template <typename Builder>
+    static constexpr typename Builder::Value parseDouble(std::string_view json, size_t& pos, const char* digits, const char* p, uint64_t magnitude, bool negative, Builder& b, JsonErrorCode& error) {
+        const char* const end = json.data() + json.size();
+        const bool wrapped = p - digits > 19; // magnitude lost integer digits
+        bool anyDigits = p > digits;
+        bool truncated = false; // nonzero fraction digits were dropped
+        int64_t exponent = 0;
+        if (*p == '.') {
+            const char* const fraction = ++p;
+            if (std::endian::native == std::endian::little && !std::is_constant_evaluated()) {
+                // Up to eight digits at a time while they can't overflow
+                uint64_t chunk;
+                while (end - p >= 8 && magnitude < 10000000000u) {
+                    std::memcpy(&chunk, p, 8);
+                    const int n = leadingDigits(chunk);
+                    if (n == 0)
+                        break;
+                    if (n < 8)
+                        chunk = chunk << (64 - 8 * n) | (0x3030303030303030 >> (8 * n)); // shift in leading zeros
+                    magnitude = magnitude * kScales[n] + parseEightDigits(chunk);
+                    exponent -= n;
+                    p += n;
+                    if (n < 8)
+                        break;
+                }
+            }
+            for (; p < end && isdigit(*p); ++p) {
+                if (magnitude < 1000000000000000000u) {
+                    magnitude = magnitude * 10 + (*p - '0');
+                    --exponent;
+                } else {
+                    truncated |= *p != '0';
+                }
+            }
+            anyDigits |= p > fraction;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            const bool negativeExponent = p < end && *p == '-';
+            if (p < end && (*p == '+' || *p == '-'))
+                ++p;
+            int64_t e = 0;
+            for (; p < end && isdigit(*p); ++p)
+                e = std::min<int64_t>(e * 10 + (*p - '0'), 100000); // far beyond any double
+            exponent += negativeExponent ? -e : e;
+        }
+
+        double num = 0;
+        if (!anyDigits || wrapped || !decimalToDouble(magnitude, exponent, truncated, negative, num)) {
+            if (std::is_constant_evaluated()) {
+                error = JsonErrorCode::InvalidNumber;
+                return {};
+            }
+            const auto result = std::from_chars(json.data() + pos, p, num);
+            if (result.ec != std::errc()) {
+                error = JsonErrorCode::InvalidNumber;
+                return {};
+            }
+        }
+        pos = p - json.data();
+        return b.number(num);
+    }
+
+    // The double nearest to w * 10^exponent, or false if the fast paths can't
+    // tell. A truncated w is a prefix of longer digits, which round the same
+    // way as long as w and w + 1 do.
+    static constexpr bool decimalToDouble(uint64_t w, int64_t exponent, bool truncated, bool negative, double& out) {
+        uint64_t bits = 0;
+        if (w != 0) {
+#if FLT_EVAL_METHOD == 0
+            // Clinger: w and the power of ten are exact doubles, so one
+            // correctly rounded operation gives the correctly rounded result
+            if (!truncated && w <= uint64_t(1) << 53 && exponent >= -22 && exponent <= 22) {
+                const double d = exponent < 0 ? double(w) / kExactPowersOfTen[-exponent] : double(w) * kExactPowersOfTen[exponent];
+                out = negative ? -d : d;
+                return true;
+            }
+#endif
+            uint64_t upper;
+            if (!eiselLemire(w, exponent, bits) || (truncated && (!eiselLemire(w + 1, exponent, upper) || upper != bits)))
+                return false;
+        }
+        out = std::bit_cast<double>(bits | uint64_t(negative) << 63);
+        return true;
+    }
+
+    // Eisel and Lemire's conversion of a nonzero w * 10^exponent to the bits of
+    // a positive double: the product of w and a 128-bit approximation of the
+    // power of ten usually settles the rounding. Fails when it doesn't, and for
+    // powers outside kPowersOfTen.
+    static constexpr bool eiselLemire(uint64_t w, int64_t exponent, uint64_t& bits) {
+        if (exponent < kMinExponent10 || exponent > kMaxExponent10)
+            return false;
+        const int leadingZeros = std::countl_zero(w);
+        w <<= leadingZeros;
+        const auto& power = kPowersOfTen[exponent - kMinExponent10];
+        auto [high, low] = multiply128(w, power[0]);
+        // The bits below the mantissa are all ones, so the truncated low half
+        // of the power might carry into it
+        if ((high & 0x1FF) == 0x1FF && low + w < w) {
+            const auto [carryHigh, carryLow] = multiply128(w, power[1]);
+            const uint64_t mergedLow = low + carryHigh;
+            const uint64_t mergedHigh = high + (mergedLow < low);
+            if ((mergedHigh & 0x1FF) == 0x1FF && mergedLow + 1 == 0 && carryLow + w < w)
+                return false;
+            high = mergedHigh;
+            low = mergedLow;
+        }
+        const uint64_t top = high >> 63;
+        uint64_t mantissa = high >> (top + 9); // 54 bits, the last for rounding
+        int64_t exponent2 = ((217706 * exponent) >> 16) + 64 + 1023 - leadingZeros - (1 ^ top); // 217706 / 2^16 ~ log2(10)
+        if (low == 0 && (high & 0x1FF) == 0 && (mantissa & 3) == 1)
+            return false; // halfway between two doubles, or just above
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        if (mantissa >> 53) {
+            mantissa >>= 1;
+            ++exponent2;
+        }
+        if (exponent2 <= 0 || exponent2 >= 0x7FF)
+            return false; // subnormal or infinite
+        bits = uint64_t(exponent2) << 52 | (mantissa & ((uint64_t(1) << 52) - 1));
+        return true;
+    }
+
+    // The product of a and b as { high, low } halves.
+    static constexpr std::pair<uint64_t, uint64_t> multiply128(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+        __extension__ using uint128 = unsigned __int128;
+        const uint128 product = uint128(a) * b;
+        return { uint64_t(product >> 64), uint64_t(product) };
+#else
+        const uint64_t aLow = uint32_t(a), aHigh = a >> 32, bLow = uint32_t(b), bHigh = b >> 32;
+        const uint64_t lowLow = aLow * bLow, highLow = aHigh * bLow, lowHigh = aLow * bHigh;
+        const uint64_t middle = (lowLow >> 32) + uint32_t(highLow) + uint32_t(lowHigh);
+        return { aHigh * bHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32), middle << 32 | uint32_t(lowLow) };
+#endif
+    }
+
+    static constexpr uint64_t kScales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+    static constexpr double kExactPowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16,
+        1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    // The 128 most significant bits of 10^e, rounded down, as { high, low } for
+    // e from kMinExponent10 to kMaxExponent10. Numbers further out are rare
+    // enough to leave to std::from_chars.
+    static constexpr int kMinExponent10 = -64;
+    static constexpr int kMaxExponent10 = 64;
+    static constexpr uint64_t kPowersOfTen[][2] = {
+        { 0xA87FEA27A539E9A5, 0x3F2398D747B36224 }, { 0xD29FE4B18E88640E, 0x8EEC7F0D19A03AAD },
+        { 0x83A3EEEEF9153E89, 0x1953CF68300424AC }, { 0xA48CEAAAB75A8E2B, 0x5FA8C3423C052DD7 },
+        { 0xCDB02555653131B6, 0x3792F412CB06794D }, { 0x808E17555F3EBF11, 0xE2BBD88BBEE40BD0 },
+        { 0xA0B19D2AB70E6ED6, 0x5B6ACEAEAE9D0EC4 }, { 0xC8DE047564D20A8B, 0xF245825A5A445275 },
+        { 0xFB158592BE068D2E, 0xEED6E2F0F0D56712 }, { 0x9CED737BB6C4183D, 0x55464DD69685606B },
+        { 0xC428D05AA4751E4C, 0xAA97E14C3C26B886 }, { 0xF53304714D9265DF, 0xD53DD99F4B3066A8 },
+        { 0x993FE2C6D07B7FAB, 0xE546A8038EFE4029 }, { 0xBF8FDB78849A5F96, 0xDE98520472BDD033 },
+        { 0xEF73D256A5C0F77C, 0x963E66858F6D4440 }, { 0x95A8637627989AAD, 0xDDE7001379A44AA8 },
+        { 0xBB127C53B17EC159, 0x5560C018580D5D52 }, { 0xE9D71B689DDE71AF, 0xAAB8F01E6E10B4A6 },
+        { 0x9226712162AB070D, 0xCAB3961304CA70E8 }, { 0xB6B00D69BB55C8D1, 0x3D607B97C5FD0D22 },
+        { 0xE45C10C42A2B3B05, 0x8CB89A7DB77C506A }, { 0x8EB98A7A9A5B04E3, 0x77F3608E92ADB242 },
+        { 0xB267ED1940F1C61C, 0x55F038B237591ED3 }, { 0xDF01E85F912E37A3, 0x6B6C46DEC52F6688 },
+        { 0x8B61313BBABCE2C6, 0x2323AC4B3B3DA015 }, { 0xAE397D8AA96C1B77, 0xABEC975E0A0D081A },
+        { 0xD9C7DCED53C72255, 0x96E7BD358C904A21 }, { 0x881CEA14545C7575, 0x7E50D64177DA2E54 },
+        { 0xAA242499697392D2, 0xDDE50BD1D5D0B9E9 }, { 0xD4AD2DBFC3D07787, 0x955E4EC64B44E864 },
+        { 0x84EC3C97DA624AB4, 0xBD5AF13BEF0B113E }, { 0xA6274BBDD0FADD61, 0xECB1AD8AEACDD58E },
+        { 0xCFB11EAD453994BA, 0x67DE18EDA5814AF2 }, { 0x81CEB32C4B43FCF4, 0x80EACF948770CED7 },
+        { 0xA2425FF75E14FC31, 0xA1258379A94D028D }, { 0xCAD2F7F5359A3B3E, 0x096EE45813A04330 },
+        { 0xFD87B5F28300CA0D, 0x8BCA9D6E188853FC }, { 0x9E74D1B791E07E48, 0x775EA264CF55347D },
+        { 0xC612062576589DDA, 0x95364AFE032A819D }, { 0xF79687AED3EEC551, 0x3A83DDBD83F52204 },
+        { 0x9ABE14CD44753B52, 0xC4926A9672793542 }, { 0xC16D9A0095928A27, 0x75B7053C0F178293 },
+        { 0xF1C90080BAF72CB1, 0x5324C68B12DD6338 }, { 0x971DA05074DA7BEE, 0xD3F6FC16EBCA5E03 },
+        { 0xBCE5086492111AEA, 0x88F4BB1CA6BCF584 }, { 0xEC1E4A7DB69561A5, 0x2B31E9E3D06C32E5 },
+        { 0x9392EE8E921D5D07, 0x3AFF322E62439FCF }, { 0xB877AA3236A4B449, 0x09BEFEB9FAD487C2 },
+        { 0xE69594BEC44DE15B, 0x4C2EBE687989A9B3 }, { 0x901D7CF73AB0ACD9, 0x0F9D37014BF60A10 },
+        { 0xB424DC35095CD80F, 0x538484C19EF38C94 }, { 0xE12E13424BB40E13, 0x2865A5F206B06FB9 },
+        { 0x8CBCCC096F5088CB, 0xF93F87B7442E45D3 }, { 0xAFEBFF0BCB24AAFE, 0xF78F69A51539D748 },
+        { 0xDBE6FECEBDEDD5BE, 0xB573440E5A884D1B }, { 0x89705F4136B4A597, 0x31680A88F8953030 },
+        { 0xABCC77118461CEFC, 0xFDC20D2B36BA7C3D }, { 0xD6BF94D5E57A42BC, 0x3D32907604691B4C },
+        { 0x8637BD05AF6C69B5, 0xA63F9A49C2C1B10F }, { 0xA7C5AC471B478423, 0x0FCF80DC33721D53 },
+        { 0xD1B71758E219652B, 0xD3C36113404EA4A8 }, { 0x83126E978D4FDF3B, 0x645A1CAC083126E9 },
+        { 0xA3D70A3D70A3D70A, 0x3D70A3D70A3D70A3 }, { 0xCCCCCCCCCCCCCCCC, 0xCCCCCCCCCCCCCCCC },
+        { 0x8000000000000000, 0x0000000000000000 }, { 0xA000000000000000, 0x0000000000000000 },
+        { 0xC800000000000000, 0x0000000000000000 }, { 0xFA00000000000000, 0x0000000000000000 },
+        { 0x9C40000000000000, 0x0000000000000000 }, { 0xC350000000000000, 0x0000000000000000 },
+        { 0xF424000000000000, 0x0000000000000000 }, { 0x9896800000000000, 0x0000000000000000 },
+        { 0xBEBC200000000000, 0x0000000000000000 }, { 0xEE6B280000000000, 0x0000000000000000 },
+        { 0x9502F90000000000, 0x0000000000000000 }, { 0xBA43B74000000000, 0x0000000000000000 },
+        { 0xE8D4A51000000000, 0x0000000000000000 }, { 0x9184E72A00000000, 0x0000000000000000 },
+        { 0xB5E620F480000000, 0x0000000000000000 }, { 0xE35FA931A0000000, 0x0000000000000000 },
+        { 0x8E1BC9BF04000000, 0x0000000000000000 }, { 0xB1A2BC2EC5000000, 0x0000000000000000 },
+        { 0xDE0B6B3A76400000, 0x0000000000000000 }, { 0x8AC7230489E80000, 0x0000000000000000 },
+        { 0xAD78EBC5AC620000, 0x0000000000000000 }, { 0xD8D726B7177A8000, 0x0000000000000000 },
+        { 0x878678326EAC9000, 0x0000000000000000 }, { 0xA968163F0A57B400, 0x0000000000000000 },
+        { 0xD3C21BCECCEDA100, 0x0000000000000000 }, { 0x84595161401484A0, 0x0000000000000000 },
+        { 0xA56FA5B99019A5C8, 0x0000000000000000 }, { 0xCECB8F27F4200F3A, 0x0000000000000000 },
+        { 0x813F3978F8940984, 0x4000000000000000 }, { 0xA18F07D736B90BE5, 0x5000000000000000 },
+        { 0xC9F2C9CD04674EDE, 0xA400000000000000 }, { 0xFC6F7C4045812296, 0x4D00000000000000 },
+        { 0x9DC5ADA82B70B59D, 0xF020000000000000 }, { 0xC5371912364CE305, 0x6C28000000000000 },
+        { 0xF684DF56C3E01BC6, 0xC732000000000000 }, { 0x9A130B963A6C115C, 0x3C7F400000000000 },
+        { 0xC097CE7BC90715B3, 0x4B9F100000000000 }, { 0xF0BDC21ABB48DB20, 0x1E86D40000000000 },
+        { 0x96769950B50D88F4, 0x1314448000000000 }, { 0xBC143FA4E250EB31, 0x17D955A000000000 },
+        { 0xEB194F8E1AE525FD, 0x5DCFAB0800000000 }, { 0x92EFD1B8D0CF37BE, 0x5AA1CAE500000000 },
+        { 0xB7ABC627050305AD, 0xF14A3D9E40000000 }, { 0xE596B7B0C643C719, 0x6D9CCD05D0000000 },
+        { 0x8F7E32CE7BEA5C6F, 0xE4820023A2000000 }, { 0xB35DBF821AE4F38B, 0xDDA2802C8A800000 },
+        { 0xE0352F62A19E306E, 0xD50B2037AD200000 }, { 0x8C213D9DA502DE45, 0x4526F422CC340000 },
+        { 0xAF298D050E4395D6, 0x9670B12B7F410000 }, { 0xDAF3F04651D47B4C, 0x3C0CDD765F114000 },
+        { 0x88D8762BF324CD0F, 0xA5880A69FB6AC800 }, { 0xAB0E93B6EFEE0053, 0x8EEA0D047A457A00 },
+        { 0xD5D238A4ABE98068, 0x72A4904598D6D880 }, { 0x85A36366EB71F041, 0x47A6DA2B7F864750 },
+        { 0xA70C3C40A64E6C51, 0x999090B65F67D924 }, { 0xD0CF4B50CFE20765, 0xFFF4B4E3F741CF6D },
+        { 0x82818F1281ED449F, 0xBFF8F10E7A8921A4 }, { 0xA321F2D7226895C7, 0xAFF72D52192B6A0D },
+        { 0xCBEA6F8CEB02BB39, 0x9BF4F8A69F764490 }, { 0xFEE50B7025C36A08, 0x02F236D04753D5B4 },
+        { 0x9F4F2726179A2245, 0x01D762422C946590 }, { 0xC722F0EF9D80AAD6, 0x424D3AD2B7B97EF5 },
+        { 0xF8EBAD2B84E0D58B, 0xD2E0898765A7DEB2 }, { 0x9B934C3B330C8577, 0x63CC55F49F88EB2F },
+        { 0xC2781F49FFCFA6D5, 0x3CBF6B71C76B25FB },
+    };
+
+    // Whether all eight bytes of chunk, loaded little-endian, are ASCII digits.
+    static constexpr bool isEightDigits(uint64_t chunk) {
+        return ((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+    }
+
+    // How many ASCII digits chunk, loaded little-endian, starts with. A carry
+    // out of a byte comes from a non-digit, so can't hide an earlier one.
+    static constexpr int leadingDigits(uint64_t chunk) {
+        const uint64_t nonDigits = ((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ^ 0x3333333333333333;
+        return std::countr_zero(nonDigits) / 8;
+    }
+
+    // The value of eight digits, combining pairs, then quads, then halves.
+    static constexpr uint32_t parseEightDigits(uint64_t chunk) {
+        chunk -= 0x3030303030303030;
+        chunk = (chunk * 10) + (chunk >> 8);
+        chunk = (((chunk & 0x000000FF000000FF) * (100 + (1000000ull << 32))) + (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32)))) >> 32;
+        return static_cast<uint32_t>(chunk);
+    }
+
+    // Reads big-endian binary encodings. Like TextCursor, the first error is
+    // kept with pos left at its offset.
+    struct BinaryCursor {
+        std::string_view bytes;
+        size_t pos;
+        size_t maxDepth = JsonParseOptions {}.maxDepth;
+        size_t depth = 0; // containers and tags being decoded
+        JsonErrorCode error = JsonErrorCode::None;
+
+        bool failed() const {
+            return error != JsonErrorCode::None;
+        }
+
+        void fail(JsonErrorCode code, size_t offset) {
+            if (!failed()) {
+                error = code;
+                pos = offset;
+            }
+        }
+
+        // Enters the container or tag at offset. The decoders recurse, so
+        // this bounds their stack use. Callers leave with --depth.
+        bool enter(size_t offset) {
+            if (depth < maxDepth) {
+                ++depth;
+                return true;
+            }
+            fail(JsonErrorCode::DepthLimitExceeded, offset);
+            return false;
+        }
+
+        // The next n-byte unsigned integer, or 0 at the end of the input.
+        uint64_t read(size_t n) {
+            if (bytes.size() - pos < n) {
+                fail(JsonErrorCode::UnexpectedEnd, bytes.size());
+                return 0;
+            }
+            uint64_t value = 0;
+            for (size_t i = 0; i < n; ++i)
+                value = value << 8 | static_cast<uint8_t>(bytes[pos + i]);
+            pos += n;
+            return value;
+        }
+
+        std::string_view take(uint64_t n) {
+            if (bytes.size() - pos < n) {
+                fail(JsonErrorCode::UnexpectedEnd, bytes.size());
+                return {};
+            }
+            const std::string_view str = bytes.substr(pos, n);
+            pos += n;
+            return str;
+        }
+
+        // take for a text string, which must be UTF-8 if validate is set.
+        std::string_view text(uint64_t n, bool validate) {
+            const std::string_view str = take(n);
+            if (validate && !failed()) {
+                const char* const invalid = JsonSimd::validateUtf8(str.data(), str.data() + str.size());
+                if (invalid != str.data() + str.size())
+                    fail(JsonErrorCode::InvalidUtf8, invalid - bytes.data());
+            }
+            return str;
+        }
+
+        // Consumes the CBOR break code ending an indefinite-length item.
+        bool atBreak() {
+            if (pos < bytes.size() && static_cast<uint8_t>(bytes[pos]) == 0xFF) {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    template <typename Builder>
+    static JsonResult<typename Builder::Value> parseBinaryValue(std::string_view bytes, JsonBinaryFormat format, Builder& b, size_t maxDepth) {
+        BinaryCursor in { bytes, 0, maxDepth };
+        auto value = format == JsonBinaryFormat::Cbor ? parseCbor(in, b) : parseMessagePack(in, b);
+        if (!in.failed() && in.pos != bytes.size())
+            in.fail(JsonErrorCode::TrailingData, in.pos);
+        if (in.failed())
+            return JsonError { in.error, in.pos };
+        return value;
+    }
+
+    template <typename Builder>
+    static typename Builder::Value parseCbor(BinaryCursor& in, Builder& b) {
+        const size_t start = in.pos;
+        const uint8_t initial = static_cast<uint8_t>(in.read(1));
+        if (in.failed())
+            return {};
+        const uint8_t major = initial >> 5;
+        const uint8_t info = initial & 0x1F;
+        if (major == 7)
+            return parseCborSimple(in, b, info, start);
+
+        const bool indefinite = info == 31 && major >= 2 && major <= 5;
+        if (info >= 28 && !indefinite) {
+            in.fail(JsonErrorCode::InvalidBinary, start);
+            return {};
+        }
+        const uint64_t arg = indefinite ? 0 : readCborArgument(in, info);
+        if (in.failed())
+            return {};
+
+        switch (major) {
+        case 0: return integer(b, arg, false);
+        case 1: {
+            if (arg < 9223372036854775808u)
+                return integer(b, arg + 1, true);
+            char magnitude[8];
+            for (size_t i = 0; i < 8; ++i)
+                magnitude[i] = static_cast<char>(arg >> (56 - 8 * i));
+            return bignum(b, { magnitude, 8 }, true);
+        }
+        case 3: {
+            std::string scratch;
+            const std::string_view str = parseCborText(in, arg, indefinite, scratch, b.validateUtf8);
+            if (in.failed())
+                return {};
+            return b.string(str, !indefinite);
+        }
+        case 4: {
+            if (!in.enter(start))
+                return {};
+            auto arr = b.startArray();
+            b.reserve(arr, std::min<uint64_t>(arg, in.bytes.size() - in.pos)); // every element takes a byte
+            for (uint64_t i = 0; indefinite ? !in.atBreak() : i < arg; ++i) {
+                auto value = parseCbor(in, b);
+                if (in.failed())
+                    return {};
+                b.element(arr, std::move(value));
+            }
+            --in.depth;
+            return b.endArray(std::move(arr));
+        }
+        case 5: {
+            if (!in.enter(start))
+                return {};
+            auto obj = b.startObject();
+            b.reserve(obj, std::min<uint64_t>(arg, (in.bytes.size() - in.pos) / 2));
+            std::string scratch;
+            for (uint64_t i = 0; indefinite ? !in.atBreak() : i < arg; ++i) {
+                const size_t keyStart = in.pos;
+                const uint8_t keyInitial = static_cast<uint8_t>(in.read(1));
+                const uint8_t keyInfo = keyInitial & 0x1F;
+                if (!in.failed() && (keyInitial >> 5 != 3 || (keyInfo >= 28 && keyInfo != 31)))
+                    in.fail(JsonErrorCode::InvalidBinary, keyStart);
+                if (in.failed())
+                    return {};
+                const bool keyIndefinite = keyInfo == 31;
+                const std::string_view str = parseCborText(in, keyIndefinite ? 0 : readCborArgument(in, keyInfo), keyIndefinite, scratch, b.validateUtf8);
+                if (in.failed())
+                    return {};
+                auto key = b.key(str, !keyIndefinite);
+                auto value = parseCbor(in, b);
+                if (in.failed())
+                    return {};
+                b.member(obj, std::move(key), std::move(value));
+            }
+            --in.depth;
+            return b.endObject(std::move(obj));
+        }
+        case 6: {
+            if (arg != 2 && arg != 3) {
+                // Other tags only annotate their content
+                if (!in.enter(start))
+                    return {};
+                auto value = parseCbor(in, b);
+                --in.depth;
+                return value;
+            }
+            const size_t contentStart = in.pos;
+            const uint8_t content = static_cast<uint8_t>(in.read(1));
+            if (in.failed())
+                return {};
+            if (content >> 5 != 2 || (content & 0x1F) >= 28) {
+                in.fail(JsonErrorCode::InvalidBinary, contentStart);
+                return {};
+            }
+            const std::string_view magnitude = in.take(readCborArgument(in, content & 0x1F));
+            if (in.failed())
+                return {};
+            return bignum(b, magnitude, arg == 3);
+        }
+        default: // byte strings
+            in.fail(JsonErrorCode::InvalidBinary, start);
+            return {};
+        }
+    }
+
+    // The argument following an initial byte whose low five bits are info,
+    // which must be below 28.
+    static uint64_t readCborArgument(BinaryCursor& in, uint8_t info) {
+        return info < 24 ? info : in.read(size_t(1) << (info - 24));
+    }
+
+    template <typename Builder>
+    static typename Builder::Value parseCborSimple(BinaryCursor& in, Builder& b, uint8_t info, size_t start) {
+        switch (info) {
+        case 20: return b.boolean(false);
+        case 21: return b.boolean(true);
+        case 22:
+        case 23: return b.null(); // undefined has no JSON form either
+        case 25: {
+            const uint64_t half = in.read(2);
+            if (in.failed())
+                return {};
+            const int exponent = (half >> 10) & 0x1F;
+            const double mantissa = static_cast<double>(half & 0x3FF);
+            double value = exponent == 0 ? std::ldexp(mantissa, -24)
+                : exponent == 31         ? (mantissa == 0 ? INFINITY : NAN)
+                                         : std::ldexp(mantissa + 1024, exponent - 25);
+            return b.number(half & 0x8000 ? -value : value);
+        }
+        case 26: {
+            const auto bits = static_cast<uint32_t>(in.read(4));
+            if (in.failed())
+                return {};
+            return b.number(static_cast<double>(std::bit_cast<float>(bits)));
+        }
+        case 27: {
+            const uint64_t bits = in.read(8);
+            if (in.failed())
+                return {};
+            return b.number(std::bit_cast<double>(bits));
+        }
+        default: in.fail(JsonErrorCode::InvalidBinary, start); return {};
+        }
+    }
+
+    // A definite text string as a view of the input, or the chunks of an
+    // indefinite one joined in scratch. Each chunk must be UTF-8 by itself.
+    static std::string_view parseCborText(BinaryCursor& in, uint64_t length, bool indefinite, std::string& scratch, bool validate) {
+        if (!indefinite)
+            return in.text(length, validate);
+        scratch.clear();
+        while (!in.atBreak()) {
+            const size_t chunkStart = in.pos;
+            const uint8_t chunk = static_cast<uint8_t>(in.read(1));
+            if (in.failed())
+                return {};
+            if (chunk >> 5 != 3 || (chunk & 0x1F) >= 28) {
+                in.fail(JsonErrorCode::InvalidBinary, chunkStart);
+                return {};
+            }
+            scratch += in.text(readCborArgument(in, chunk & 0x1F), validate);
+            if (in.failed())
+                return {};
+        }
+        return scratch;
+    }
+
+    // A CBOR bignum: magnitude holds the big-endian value, or -1 - value if
+    // negative. Values beyond 64 bits become RawNumber or double, like JSON text.
+    template <typename Builder>
+    static typename Builder::Value bignum(Builder& b, std::string_view magnitude, bool negative) {
+        while (!magnitude.empty() && magnitude.front() == 0)
+            magnitude.remove_prefix(1);
+        uint64_t n = 0;
+        for (size_t i = 0; i < magnitude.size() && i < 8; ++i)
+            n = n << 8 | static_cast<uint8_t>(magnitude[i]);
+        if (magnitude.size() <= 8 && (!negative || n < 9223372036854775808u))
+            return integer(b, n + negative, negative);
+
+        if (!b.rawBigIntegers) {
+            double value = 0;
+            for (const char byte : magnitude)
+                value = value * 256 + static_cast<uint8_t>(byte);
+            return b.number(negative ? -1 - value : value);
+        }
+
+        // Repeated division by ten of the (incremented, if negative) magnitude
+        std::vector<uint8_t> digits256(magnitude.begin(), magnitude.end());
+        for (size_t i = digits256.size(); negative && i-- > 0;) {
+            if (++digits256[i] != 0)
+                break;
+            if (i == 0)
+                digits256.insert(digits256.begin(), 1);
+        }
+        std::string text;
+        for (size_t first = 0; first < digits256.size();) {
+            unsigned remainder = 0;
+            for (size_t i = first; i < digits256.size(); ++i) {
+                const unsigned value = remainder << 8 | digits256[i];
+                digits256[i] = static_cast<uint8_t>(value / 10);
+                remainder = value % 10;
+            }
+            text.push_back(static_cast<char>('0' + remainder));
+            while (first < digits256.size() && digits256[first] == 0)
+                ++first;
+        }
+        if (negative)
+            text.push_back('-');
+        std::reverse(text.begin(), text.end());
+        return b.rawNumber(text, false);
+    }
+
+    template <typename Builder>
+    static typename Builder::Value parseMessagePack(BinaryCursor& in, Builder& b) {
+        const size_t start = in.pos;
+        const uint8_t c = static_cast<uint8_t>(in.read(1));
+        if (in.failed())
+            return {};
+        if (c <= 0x7F)
+            return integer(b, c, false);
+        if (c >= 0xE0)
+            return integer(b, 0x100 - c, true);
+        if ((c & 0xF0) == 0x80)
+            return parseMessagePackMap(in, b, c & 0x0F, start);
+        if ((c & 0xF0) == 0x90)
+            return parseMessagePackArray(in, b, c & 0x0F, start);
+        if ((c & 0xE0) == 0xA0 || (c >= 0xD9 && c <= 0xDB)) {
+            const uint64_t length = (c & 0xE0) == 0xA0 ? c & 0x1F : in.read(size_t(1) << (c - 0xD9));
+            const std::string_view str = in.text(length, b.validateUtf8);
+            if (in.failed())
+                return {};
+            return b.string(str, true);
+        }
+
+        switch (c) {
+        case 0xC0: return b.null();
+        case 0xC2: return b.boolean(false);
+        case 0xC3: return b.boolean(true);
+        case 0xCA: {
+            const auto bits = static_cast<uint32_t>(in.read(4));
+            if (in.failed())
+                return {};
+            return b.number(static_cast<double>(std::bit_cast<float>(bits)));
+        }
+        case 0xCB: {
+            const uint64_t bits = in.read(8);
+            if (in.failed())
+                return {};
+            return b.number(std::bit_cast<double>(bits));
+        }
+        case 0xCC:
+        case 0xCD:
+        case 0xCE:
+        case 0xCF: {
+            const uint64_t n = in.read(size_t(1) << (c - 0xCC));
+            if (in.failed())
+                return {};
+            return integer(b, n, false);
+        }
+        case 0xD0:
+        case 0xD1:
+        case 0xD2:
+        case 0xD3: {
+            const unsigned bits = 8u << (c - 0xD0);
+            const uint64_t raw = in.read(bits / 8);
+            if (in.failed())
+                return {};
+            const int64_t n = static_cast<int64_t>(raw << (64 - bits)) >> (64 - bits); // sign-extend
+            return n < 0 ? integer(b, 0 - static_cast<uint64_t>(n), true) : integer(b, static_cast<uint64_t>(n), false);
+        }
+        case 0xDC:
+        case 0xDD: {
+            const uint64_t count = in.read(c == 0xDC ? 2 : 4);
+            if (in.failed())
+                return {};
+            return parseMessagePackArray(in, b, count, start);
+        }
+        case 0xDE:
+        case 0xDF: {
+            const uint64_t count = in.read(c == 0xDE ? 2 : 4);
+            if (in.failed())
+                return {};
+            return parseMessagePackMap(in, b, count, start);
+        }
+        default: // binary, extension types and the unused 0xC1
+            in.fail(JsonErrorCode::InvalidBinary, start);
+            return {};
+        }
+    }
+
+    template <typename Builder>
+    static typename Builder::Value parseMessagePackArray(BinaryCursor& in, Builder& b, uint64_t count, size_t start) {
+        if (!in.enter(start))
+            return {};
+        auto arr = b.startArray();
+        b.reserve(arr, std::min<uint64_t>(count, in.bytes.size() - in.pos)); // every element takes a byte
+        for (uint64_t i = 0; i < count; ++i) {
+            auto value = parseMessagePack(in, b);
+            if (in.failed())
+                return {};
+            b.element(arr, std::move(value));
+        }
+        --in.depth;
+        return b.endArray(std::move(arr));
+    }
+
+    template <typename Builder>
+    static typename Builder::Value parseMessagePackMap(BinaryCursor& in, Builder& b, uint64_t count, size_t start) {
+        if (!in.enter(start))
+            return {};
+        auto obj = b.startObject();
+        b.reserve(obj, std::min<uint64_t>(count, (in.bytes.size() - in.pos) / 2));
+        for (uint64_t i = 0; i < count; ++i) {
+            const size_t keyStart = in.pos;
+            const uint8_t c = static_cast<uint8_t>(in.read(1));
+            if (in.failed())
+                return {};
+            if ((c & 0xE0) != 0xA0 && (c < 0xD9 || c > 0xDB)) {
+                in.fail(JsonErrorCode::InvalidBinary, keyStart);
+                return {};
+            }
+            const uint64_t length = (c & 0xE0) == 0xA0 ? c & 0x1F : in.read(size_t(1) << (c - 0xD9));
+            const std::string_view str = in.text(length, b.validateUtf8);
+            if (in.failed())
+                return {};
+            auto key = b.key(str, true);
+            auto value = parseMessagePack(in, b);
+            if (in.failed())
+                return {};
+            b.member(obj, std::move(key), std::move(value));
+        }
+        --in.depth;
+        return b.endObject(std::move(obj));
+    }
+};
+
+// R"({"retries": 3})"_json is JsonParser::parseStatic of the literal. In a
+// namespace of its own, as other libraries name their literals _json too.
+namespace auric_json_literals {
+template <JsonLiteral Text>
+consteval auto operator""_json() {
+    return JsonParser::parseStatic<Text>();
+}
+}
+
+// Incremental push parser. Feed the document in chunks of any size as they
+// arrive and call finish() after the last one; events reach handler (see
+// JsonSaxHandler) as soon as each token is complete. Only the token in progress
+// and the stack of open containers are buffered, so chunks may be discarded
+// once fed. The grammar matches JsonParser.
+template <typename Handler>
+class JsonStreamParser {
+public:
+    explicit JsonStreamParser(Handler& handler, const JsonParseOptions& options = {})
+        : builder { handler, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates }
+        , maxDepth(options.maxDepth) {}
+
+    void feed(std::string_view chunk) {
+        if (tryFeed(chunk))
+            throw std::runtime_error(error.message());
+    }
+
+    // Like feed, but reports malformed input through the result instead of
+    // throwing. The offset counts from the start of the first chunk; errors
+    // have no line or column. Once one is found, every further call returns
+    // it until reset().
+    JsonError tryFeed(std::string_view chunk) {
+        size_t pos = 0;
+        while (pos < chunk.size() && !error) {
+            switch (state) {
+            case State::String:
+            case State::Key: pos = feedString(chunk, pos); break;
+            case State::Number:
+            case State::Literal: pos = feedToken(chunk, pos); break;
+            default: pos = feedStructure(chunk, pos); break;
+            }
+        }
+        fed += chunk.size();
+        return error;
+    }
+
+    // Signals the end of input. Throws if the document is incomplete.
+    void finish() {
+        if (tryFinish())
+            throw std::runtime_error(error.message());
+    }
+
+    JsonError tryFinish() {
+        if (!error && (state == State::Number || state == State::Literal) && stack.empty())
+            endToken();
+        if (state != State::Done)
+            fail(JsonErrorCode::UnexpectedEnd, fed);
+        return error;
+    }
+
+    // Whether the root value has been completely parsed
+    bool done() const {
+        return state == State::Done;
+    }
+
+    // Prepares the parser for a new document.
+    void reset() {
+        state = State::Value;
+        stack.clear();
+        token.clear();
+        escape.clear();
+        inEscape = false;
+        error = {};
+        fed = 0;
+    }
+
+private:
+    enum class State : uint8_t {
+        Value, // expecting a value
+        ArrayValueOrEnd, // after '[' or ',' in an array
+        ObjectKeyOrEnd, // after '{' or ',' in an object
+        Colon, // after an object key
+        AfterValue, // expecting ',' or the end of the enclosing container
+        String,
+        Key,
+        Number,
+        Literal,
+        Done
+    };
+
+    size_t feedStructure(std::string_view chunk, size_t pos) {
+        while (pos < chunk.size() && isspace(chunk[pos]))
+            ++pos;
+        if (pos == chunk.size())
+            return pos;
+
+        const size_t at = fed + pos;
+        const char c = chunk[pos++];
+        switch (state) {
+        case State::Value:
+            beginValue(c, at);
+            break;
+        case State::ArrayValueOrEnd:
+            if (c == ']')
+                endContainer();
+            else
+                beginValue(c, at);
+            break;
+        case State::ObjectKeyOrEnd:
+            if (c == '}') {
+                endContainer();
+            } else if (c == '"') {
+                token.clear();
+                rawStart = 0;
+                state = State::Key;
+            } else {
+                fail(JsonErrorCode::ExpectedKey, at);
+            }
+            break;
+        case State::Colon:
+            if (c != ':')
+                fail(JsonErrorCode::ExpectedColon, at);
+            state = State::Value;
+            break;
+        case State::AfterValue:
+            if (stack.back() == '[') {
+                if (c == ',')
+                    state = State::ArrayValueOrEnd;
+                else if (c == ']')
+                    endContainer();
+                else
+                    fail(JsonErrorCode::ExpectedCommaOrBracket, at);
+            } else {
+                if (c == ',')
+                    state = State::ObjectKeyOrEnd;
+                else if (c == '}')
+                    endContainer();
+                else
+                    fail(JsonErrorCode::ExpectedCommaOrBrace, at);
+            }
+            break;
+        default:
+            fail(JsonErrorCode::TrailingData, at);
+        }
+        return pos;
+    }
+
+    // Starts the value whose first character c is at offset at.
+    void beginValue(char c, size_t at) {
+        if ((c == '{' || c == '[') && stack.size() >= maxDepth)
+            return fail(JsonErrorCode::DepthLimitExceeded, at);
+        tokenStart = at;
+        switch (c) {
+        case '{':
+            builder.handler.onStartObject();
+            stack.push_back('{');
+            state = State::ObjectKeyOrEnd;
+            break;
+        case '[':
+            builder.handler.onStartArray();
+            stack.push_back('[');
+            state = State::ArrayValueOrEnd;
+            break;
+        case '"':
+            token.clear();
+            rawStart = 0;
+            state = State::String;
+            break;
+        case 't':
+        case 'f':
+        case 'n':
+            token.assign(1, c);
+            state = State::Literal;
+            break;
+        default:
+            if (!isNumberChar(c))
+                return fail(JsonErrorCode::InvalidNumber, at);
+            token.assign(1, c);
+            state = State::Number;
+            break;
+        }
+    }
+
+    size_t feedString(std::string_view chunk, size_t pos) {
+        while (pos < chunk.size() && !error) {
+            if (inEscape) {
+                if (escapeComplete(chunk[pos]))
+                    decodeEscape();
+                else
+                    escape.push_back(chunk[pos++]);
+                continue;
+            }
+
+            const size_t end = JsonSimd::findQuoteOrBackslash(chunk.data() + pos, chunk.data() + chunk.size()) - chunk.data();
+            token.append(chunk.data() + pos, end - pos);
+            if (end == chunk.size())
+                return end;
+
+            // Sequences may span chunks, but not a quote or backslash. The bytes
+            // from rawStart are a run of the input that ends at end.
+            if (builder.validateUtf8) {
+                const char* const tokenEnd = token.data() + token.size();
+                const char* const invalid = JsonSimd::validateUtf8(token.data() + rawStart, tokenEnd);
+                if (invalid != tokenEnd) {
+                    fail(JsonErrorCode::InvalidUtf8, fed + end - (tokenEnd - invalid));
+                    return end;
+                }
+            }
+            pos = end + 1;
+            if (chunk[end] == '\\') {
+                inEscape = true;
+                escapeStart = fed + end;
+            } else if (state == State::Key) {
+                builder.handler.onKey(token);
+                state = State::Colon;
+                return pos;
+            } else {
+                builder.handler.onString(token);
+                endValue();
+                return pos;
+            }
+        }
+        return pos;
+    }
+
+    // Whether the escape buffered so far is whole, given the character after
+    // it. A \u escape is whole after its four hex digits, unless they are a high
+    // surrogate that a \u escape for the low one may follow.
+    bool escapeComplete(char next) const {
+        if (escape.empty())
+            return false;
+        if (escape[0] != 'u')
+            return true;
+        if (escape.size() < 5)
+            return false;
+        if (escape.size() == 5) {
+            const int32_t unit = JsonParser::decodeHex4(escape.data() + 1);
+            return unit < 0xD800 || unit > 0xDBFF || next != '\\';
+        }
+        if (escape.size() == 6)
+            return next != 'u';
+        return escape.size() == 11;
+    }
+
+    // Decodes the buffered escape. One that stopped short of the pair it was
+    // buffered as leaves the backslash after it, whose escape stays pending.
+    void decodeEscape() {
+        size_t escapePos = 0;
+        JsonErrorCode code = JsonErrorCode::None;
+        if (!JsonParser::parseEscape(escape, escapePos, token, code, builder.replaceLoneSurrogates))
+            return fail(code, escapeStart + 1 + escapePos);
+        if (escapePos < escape.size()) {
+            escape.erase(0, escapePos + 1);
+            escapeStart += escapePos + 1;
+            return;
+        }
+        escape.clear();
+        inEscape = false;
+        rawStart = token.size();
+    }
+
+    size_t feedToken(std::string_view chunk, size_t pos) {
+        const bool number = state == State::Number;
+        while (pos < chunk.size() && (number ? isNumberChar(chunk[pos]) : (chunk[pos] >= 'a' && chunk[pos] <= 'z')))
+            token.push_back(chunk[pos++]);
+        if (pos < chunk.size())
+            endToken();
+        return pos;
+    }
+
+    void endToken() {
+        if (state == State::Number) {
+            size_t pos = 0;
+            JsonErrorCode code = JsonErrorCode::None;
+            JsonParser::parseNumber(token, pos, builder, code);
+            if (code != JsonErrorCode::None || pos != token.size())
+                return fail(JsonErrorCode::InvalidNumber, tokenStart);
+        } else if (token == "true") {
+            builder.boolean(true);
+        } else if (token == "false") {
+            builder.boolean(false);
+        } else if (token == "null") {
+            builder.null();
+        } else {
+            return fail(token[0] == 'n' ? JsonErrorCode::ExpectedNull
+                    : token[0] == 't'   ? JsonErrorCode::ExpectedTrue
+                                        : JsonErrorCode::ExpectedFalse,
+                tokenStart);
+        }
+        endValue();
+    }
+
+    void endContainer() {
+        if (stack.back() == '[')
+            builder.handler.onEndArray();
+        else
+            builder.handler.onEndObject();
+        stack.pop_back();
+        endValue();
+    }
+
+    void endValue() {
+        state = stack.empty() ? State::Done : State::AfterValue;
+    }
+
+    static constexpr bool isNumberChar(char c) {
+        return isdigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    // Records the first error; feeding stops at it.
+    void fail(JsonErrorCode code, size_t offset) {
+        if (!error)
+            error = { code, offset };
+    }
+
+    JsonParser::SaxBuilder<Handler> builder;
+    size_t maxDepth;
+    State state = State::Value;
+    std::vector<char> stack; // '[' or '{' for each open container
+    std::string token; // string, number or literal in progress
+    std::string escape; // escape sequence in progress, without the backslash
+    size_t rawStart = 0; // start of the bytes in token copied since the last escape
+    bool inEscape = false;
+    size_t tokenStart = 0; // offset of the first character of the token in progress
+    size_t escapeStart = 0; // offset of the backslash of the escape in progress
+    size_t fed = 0; // bytes fed before the current chunk
+    JsonError error;
+};
+
+// A fixed set of worker threads that run parallel loops together with the
+// calling thread. Tasks must not throw.
+class JsonThreadPool {
+public:
+    // threads counts the calling thread; 0 uses one per hardware thread.
+    explicit JsonThreadPool(unsigned threads = 0) {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < threads; ++i)
+            workers.emplace_back([this] { work(); });
+    }
+
+    ~JsonThreadPool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    JsonThreadPool(const JsonThreadPool&) = delete;
+    JsonThreadPool& operator=(const JsonThreadPool&) = delete;
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+    // Calls task(i) for every i in [0, count), spread over all threads, and
+    // returns once every call has finished. Not reentrant.
+    template <typename Task>
+    void parallelFor(size_t count, Task&& task) {
+        using TaskType = std::remove_reference_t<Task>;
+        Job current { { 0 }, count, [](void* context, size_t i) { (*static_cast<TaskType*>(context))(i); }, &task };
+        {
+            std::lock_guard lock(mutex);
+            job = &current;
+            ++generation;
+        }
+        wake.notify_all();
+        run(current);
+
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this] { return busy == 0; });
+        job = nullptr;
+    }
+
+private:
+    struct Job {
+        std::atomic<size_t> next;
+        size_t count;
+        void (*invoke)(void*, size_t);
+        void* context;
+    };
+
+    static void run(Job& job) {
+        for (size_t i; (i = job.next.fetch_add(1, std::memory_order_relaxed)) < job.count;)
+            job.invoke(job.context, i);
+    }
+
+    void work() {
+        uint64_t seen = 0;
+        std::unique_lock lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            // The job may already have finished without this thread
+            if (Job* current = job) {
+                ++busy;
+                lock.unlock();
+                run(*current);
+                lock.lock();
+                if (--busy == 0)
+                    idle.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake; // a job was posted or the pool is stopping
+    std::condition_variable idle; // busy dropped to zero
+    Job* job = nullptr;
+    uint64_t generation = 0;
+    unsigned busy = 0; // workers inside the current job
+    bool stopping = false;
+};
+
+// Parses newline-delimited JSON (JSON Lines) on a thread pool. Every newline
+// ends a record, as JSON strings can't hold raw ones; lines are found with the
+// stage 1 kernels, blank lines are skipped, and every record is parsed
+// independently, so a malformed line only fails its own result. A record must
+// hold exactly one value; errors are located within the record.
+class JsonLinesParser {
+public:
+    explicit JsonLinesParser(unsigned threads = 0, const JsonParseOptions& options = {})
+        : pool(threads)
+        , options(options) {}
+
+    unsigned threads() const {
+        return pool.size();
+    }
+
+    static std::vector<std::string_view> split(std::string_view ndjson, JsonSimdLevel level = JsonSimd::activeLevel()) {
+        std::vector<std::string_view> records;
+        split(ndjson, 0, ndjson.size(), level, records);
+        return records;
+    }
+
+    // Parses every record, returning the results in input order.
+    std::vector<JsonResult<JsonValue>> parse(std::string_view ndjson) {
+        const auto records = split(ndjson);
+        std::vector<std::optional<JsonResult<JsonValue>>> parsed(records.size());
+        parseBatch(records, parsed);
+
+        std::vector<JsonResult<JsonValue>> results;
+        results.reserve(records.size());
+        for (auto& result : parsed)
+            results.push_back(std::move(*result));
+        return results;
+    }
+
+    // Calls callback(record, result) for every record in input order, on the
+    // calling thread. Input is split and parsed a batch at a time, so only one
+    // batch of results is held in memory however large ndjson is.
+    template <typename Callback>
+    void forEach(std::string_view ndjson, Callback&& callback) {
+        const size_t batchBytes = kBatchBytesPerThread * pool.size();
+        std::vector<std::string_view> records;
+        std::vector<std::optional<JsonResult<JsonValue>>> parsed;
+        for (size_t pos = 0; pos < ndjson.size();) {
+            records.clear();
+            pos = split(ndjson, pos, batchBytes, JsonSimd::activeLevel(), records);
+            parsed.clear();
+            parsed.resize(records.size());
+            parseBatch(records, parsed);
+            for (size_t i = 0; i < records.size(); ++i)
+                callback(records[i], std::move(*parsed[i]));
+        }
+    }
+
+private:
+    static constexpr size_t kBatchBytesPerThread = size_t(1) << 20;
+    static constexpr size_t kTaskBytes = size_t(1) << 16; // work claimed at once
+
+    // Appends the records from pos until the first record boundary at least
+    // minBytes later. Returns where it stopped. JSON strings can't hold raw
+    // newlines, so every newline ends a record and no quote state is carried
+    // across lines: an unterminated string fails its own line only.
+    static size_t split(std::string_view ndjson, size_t pos, size_t minBytes, JsonSimdLevel level, std::vector<std::string_view>& records) {
+        const size_t stop = pos + std::min(minBytes, ndjson.size() - pos);
+        size_t start = pos;
+        for (size_t offset = pos; offset < ndjson.size(); offset += JsonSimd::kBlockSize) {
+            JsonBlockMasks masks;
+            if (offset + JsonSimd::kBlockSize <= ndjson.size()) {
+                masks = JsonSimd::classifyBlock(ndjson.data() + offset, level);
+            } else {
+                char tail[JsonSimd::kBlockSize];
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, ndjson.data() + offset, ndjson.size() - offset);
+                masks = JsonSimd::classifyBlock(tail, level);
+            }
+            for (uint64_t newlines = masks.newline; newlines; newlines &= newlines - 1) {
+                const size_t end = offset + std::countr_zero(newlines);
+                addRecord(ndjson.substr(start, end - start), records);
+                start = end + 1;
+                if (start >= stop)
+                    return start;
+            }
+        }
+        addRecord(ndjson.substr(start), records);
+        return ndjson.size();
+    }
+
+    static void addRecord(std::string_view record, std::vector<std::string_view>& records) {
+        for (const char c : record) {
+            if (!isspace(c)) {
+                records.push_back(record);
+                return;
+            }
+        }
+    }
+
+    void parseBatch(const std::vector<std::string_view>& records, std::vector<std::optional<JsonResult<JsonValue>>>& results) {
+        // Group records into tasks of similar size for the workers to claim
+        std::vector<size_t> tasks { 0 };
+        size_t bytes = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            bytes += records[i].size();
+            if (bytes >= kTaskBytes || i + 1 == records.size()) {
+                tasks.push_back(i + 1);
+                bytes = 0;
+            }
+        }
+        pool.parallelFor(tasks.size() - 1, [&](size_t task) {
+            for (size_t i = tasks[task]; i < tasks[task + 1]; ++i)
+                results[i].emplace(parseRecord(records[i]));
+        });
+    }
+
+    JsonResult<JsonValue> parseRecord(std::string_view record) const {
+        JsonParser::TextCursor in { record, 0, options.maxDepth };
+        JsonParser::skipWhitespace(record, in.pos);
+        JsonParser::DomBuilder<JsonValue> builder { {}, options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        JsonValue value = JsonParser::parseValue(in, builder);
+        JsonParser::endRoot(in);
+        if (in.failed())
+            return JsonError::at(record, in.pos, in.error);
+        return value;
+    }
+
+    JsonThreadPool pool;
+    JsonParseOptions options;
+};
+
+// A value in raw JSON text that is only decoded when converted. Objects and
+// arrays are cursors: finding a key or index skips the values before it with
+// a block-wise bracket-matching scan instead of parsing them, and scalars and
+// subtrees go through the JsonParser grammar on access. Nothing is validated
+// up front, so malformed input throws from whichever access reaches it. The
+// text must outlive every value derived from it.
+class JsonLazyValue {
+public:
+    // options apply to every value reached from this one, when it is converted.
+    explicit JsonLazyValue(std::string_view json, const JsonParseOptions& options = {})
+        : json(json)
+        , pos(skipWhitespace(json, 0))
+        , options(options) {}
+
+    bool isNull() const {
+        return peek() == 'n';
+    }
+
+    bool isBool() const {
+        return peek() == 't' || peek() == 'f';
+    }
+
+    bool isNumber() const {
+        return peek() == '-' || isdigit(peek());
+    }
+
+    bool isString() const {
+        return peek() == '"';
+    }
+
+    bool isArray() const {
+        return peek() == '[';
+    }
+
+    bool isObject() const {
+        return peek() == '{';
+    }
+
+    // The first member named key.
+    JsonLazyValue operator[](std::string_view key) const {
+        if (const auto value = find(key))
+            return *value;
+        throw std::runtime_error("Key not found: " + std::string(key));
+    }
+
+    std::optional<JsonLazyValue> find(std::string_view key) const {
+        std::optional<JsonLazyValue> found;
+        scanObject([&](std::string_view rawKey, bool escaped, size_t valuePos) {
+            if (escaped ? decodeKey(rawKey) == key : rawKey == key) {
+                found = child(valuePos);
+                return false;
+            }
+            return true;
+        });
+        return found;
+    }
+
+    JsonLazyValue operator[](size_t index) const {
+        std::optional<JsonLazyValue> found;
+        scanArray([&](size_t valuePos) {
+            if (index-- == 0) {
+                found = child(valuePos);
+                return false;
+            }
+            return true;
+        });
+        if (!found)
+            throw std::runtime_error("Index out of range");
+        return *found;
+    }
+
+    // Number of elements or members.
+    size_t size() const {
+        size_t count = 0;
+        if (isArray())
+            scanArray([&](size_t) { return ++count, true; });
+        else
+            scanObject([&](std::string_view, bool, size_t) { return ++count, true; });
+        return count;
+    }
+
+    // Calls callback(JsonLazyValue) for every element.
+    template <typename Callback>
+    void forEachElement(Callback&& callback) const {
+        scanArray([&](size_t valuePos) {
+            callback(child(valuePos));
+            return true;
+        });
+    }
+
+    // Calls callback(std::string_view key, JsonLazyValue) for every member.
+    template <typename Callback>
+    void forEachMember(Callback&& callback) const {
+        scanObject([&](std::string_view rawKey, bool escaped, size_t valuePos) {
+            if (escaped)
+                callback(std::string_view(decodeKey(rawKey)), child(valuePos));
+            else
+                callback(rawKey, child(valuePos));
+            return true;
+        });
+    }
+
+    bool toBool() const {
+        return materialize().toBool();
+    }
+
+    int toInt() const {
+        return materialize().toInt();
+    }
+
+    int64_t toInt64() const {
+        return materialize().toInt64();
+    }
+
+    uint64_t toUInt64() const {
+        return materialize().toUInt64();
+    }
+
+    double toDouble() const {
+        return materialize().toDouble();
+    }
+
+    std::string toString() const {
+        return materialize().toString();
+    }
+
+    // Parses this value and everything below it.
+    JsonValue materialize() const {
+        JsonParser::TextCursor in { json, pos, options.maxDepth };
+        JsonValue value = materialize(in);
+        if (in.failed())
+            throw std::runtime_error(JsonError::message(in.error));
+        return value;
+    }
+
+    // Fails with the error located in the whole text.
+    JsonResult<JsonValue> tryMaterialize() const {
+        JsonParser::TextCursor in { json, pos, options.maxDepth };
+        JsonValue value = materialize(in);
+        if (in.failed())
+            return JsonError::at(json, in.pos, in.error);
+        return value;
+    }
+
+    // The text of this value.
+    std::string_view raw() const {
+        return json.substr(pos, skipValue(json, pos) - pos);
+    }
+
+private:
+    friend class JsonPath;
+
+    JsonLazyValue(std::string_view json, size_t pos, const JsonParseOptions& options)
+        : json(json)
+        , pos(pos)
+        , options(options) {}
+
+    JsonValue materialize(JsonParser::TextCursor& in) const {
+        JsonParser::DomBuilder<JsonValue> builder { {}, options.borrowStrings, options.indexObjects, options.rawBigIntegers, options.validateUtf8, options.replaceLoneSurrogates };
+        return JsonParser::parseValue(in, builder);
+    }
+
+    // The value at valuePos in the same text.
+    JsonLazyValue child(size_t valuePos) const {
+        return JsonLazyValue(json, valuePos, options);
+    }
+
+    char peek() const {
+        return at(json, pos);
+    }
+
+    static char at(std::string_view json, size_t pos) {
+        return pos < json.size() ? json[pos] : '\0';
+    }
+
+    static size_t skipWhitespace(std::string_view json, size_t pos) {
+        JsonParser::skipWhitespace(json, pos);
+        return pos;
+    }
+
+    [[noreturn]] static void fail(std::string_view json, size_t pos, JsonErrorCode code) {
+        throw std::runtime_error(JsonError::message(pos < json.size() ? code : JsonErrorCode::UnexpectedEnd));
+    }
+
+    // Calls visit(rawKey, escaped, valuePos) for each member until it returns
+    // false. rawKey excludes the quotes and still has its escape sequences.
+    template <typename Visit>
+    void scanObject(Visit&& visit) const {
+        if (!isObject())
+            throw std::runtime_error("Value is not an object");
+        size_t p = skipWhitespace(json, pos + 1);
+        if (at(json, p) == '}')
+            return;
+        while (true) {
+            if (at(json, p) != '"')
+                fail(json, p, JsonErrorCode::ExpectedKey);
+            bool escaped = false;
+            const size_t end = JsonParser::findStringEnd(json, p, escaped);
+            if (end == json.size())
+                fail(json, end, JsonErrorCode::UnexpectedEnd);
+            const std::string_view rawKey = json.substr(p + 1, end - p - 1);
+            p = skipWhitespace(json, end + 1);
+            if (at(json, p) != ':')
+                fail(json, p, JsonErrorCode::ExpectedColon);
+            p = skipWhitespace(json, p + 1);
+            if (!visit(rawKey, escaped, p))
+                return;
+            p = skipWhitespace(json, skipValue(json, p));
+            if (at(json, p) == '}')
+                return;
+            if (at(json, p) != ',')
+                fail(json, p, JsonErrorCode::ExpectedCommaOrBrace);
+            p = skipWhitespace(json, p + 1);
+            if (at(json, p) == '}')
+                return; // Allow trailing comma
+        }
+    }
+
+    // Calls visit(valuePos) for each element until it returns false.
+    template <typename Visit>
+    void scanArray(Visit&& visit) const {
+        if (!isArray())
+            throw std::runtime_error("Value is not an array");
+        size_t p = skipWhitespace(json, pos + 1);
+        if (at(json, p) == ']')
+            return;
+        while (true) {
+            if (!visit(p))
+                return;
+            p = skipWhitespace(json, skipValue(json, p));
+            if (at(json, p) == ']')
+                return;
+            if (at(json, p) != ',')
+                fail(json, p, JsonErrorCode::ExpectedCommaOrBracket);
+            p = skipWhitespace(json, p + 1);
+            if (at(json, p) == ']')
+                return; // Allow trailing comma
+        }
+    }
+
+    std::string decodeKey(std::string_view rawKey) const {
+        std::string key;
+        size_t p = rawKey.data() - json.data() - 1; // opening quote
+        JsonErrorCode error = JsonErrorCode::None;
+        if (!JsonParser::parseString(json, p, key, error, options.replaceLoneSurrogates))
+            fail(json, p, error);
+        return key;
+    }
+
+    // Position just past the value starting at pos.
+    static size_t skipValue(std::string_view json, size_t pos) {
+        switch (at(json, pos)) {
+        case '"': {
+            bool escaped = false;
+            const size_t end = JsonParser::findStringEnd(json, pos, escaped);
+            if (end == json.size())
+                fail(json, end, JsonErrorCode::UnexpectedEnd);
+            return end + 1;
+        }
+        case '{':
+        case '[': return skipContainer(json, pos);
+        default: break;
+        }
+        // Scalars run to the next delimiter and are checked when converted
+        const size_t start = pos;
+        while (pos < json.size() && !isspace(json[pos]) && json[pos] != ',' && json[pos] != ']' && json[pos] != '}')
+            ++pos;
+        if (pos == start)
+            fail(json, pos, JsonErrorCode::UnexpectedCharacter);
+        return pos;
+    }
+
+    // Matches the bracket at pos a block at a time: the stage 1 kernels find
+    // structural characters outside strings, and only those are inspected.
+    static size_t skipContainer(std::string_view json, size_t pos) {
+        const JsonSimdLevel level = JsonSimd::activeLevel();
+        JsonStringScanner strings;
+        size_t depth = 0;
+        for (size_t offset = pos; offset < json.size(); offset += JsonSimd::kBlockSize) {
+            JsonBlockMasks masks;
+            if (offset + JsonSimd::kBlockSize <= json.size()) {
+                masks = JsonSimd::classifyBlock(json.data() + offset, level);
+            } else {
+                char tail[JsonSimd::kBlockSize];
+                std::memset(tail, ' ', sizeof(tail));
+                std::memcpy(tail, json.data() + offset, json.size() - offset);
+                masks = JsonSimd::classifyBlock(tail, level);
+            }
+            uint64_t inString;
+            strings.next(masks, inString);
+            for (uint64_t structural = masks.structural & ~inString; structural; structural &= structural - 1) {
+                const size_t i = offset + std::countr_zero(structural);
+                const char c = json[i];
+                if (c == '{' || c == '[')
+                    ++depth;
+                else if ((c == '}' || c == ']') && --depth == 0)
+                    return i + 1;
+            }
+        }
+        fail(json, json.size(), JsonErrorCode::UnexpectedEnd);
+    }
+
+    std::string_view json;
+    size_t pos = 0;
+    JsonParseOptions options;
+};
+
+template <typename T>
+inline constexpr bool kIsJsonValue = false;
+template <typename String, template <typename> class Allocator>
+inline constexpr bool kIsJsonValue<BasicJsonValue<String, Allocator>> = true;
+
+// A query compiled once and then evaluated against any number of trees, or
+// directly against their text. It is either a JSON Pointer (RFC 6901), empty
+// or starting with '/':
+//     /store/book/0/title      ~1 and ~0 stand for '/' and '~' in keys
+// or a path expression in the style of JSONPath (RFC 9535), starting with '$':
+//     $.store.book[*].title    members by name, elements by index, wildcards
+//     $['odd key'][-1]         quoted names; negative indexes count from the end
+//     $.items[1:10:2]          slices [start:end:step], as in Python
+//     $..price                 recursive descent: price members at any depth
+// Filters and unions are not supported. Names select the first member with
+// that name, like Object::find, so a pointer selects at most one value.
+class JsonPath {
+public:
+    static JsonPath compile(std::string_view path) {
+        return tryCompile(path).value();
+    }
+
+    // Fails with InvalidPath at the offending character.
+    static JsonResult<JsonPath> tryCompile(std::string_view path) {
+        JsonPath compiled;
+        size_t pos = 0;
+        const bool valid = path.empty() || path[0] == '/' ? compiled.compilePointer(path, pos) : compiled.compileExpression(path, pos);
+        if (!valid)
+            return JsonError::at(path, pos, JsonErrorCode::InvalidPath);
+        return compiled;
+    }
+
+    // Calls callback(value) for every match, in document order. Json is a
+    // JsonValue or JsonDocument::Value, const or not.
+    template <typename Json, typename Callback>
+        requires kIsJsonValue<std::remove_const_t<Json>>
+    void forEach(Json& root, Callback&& callback) const {
+        auto match = [&](Json& value) {
+            callback(value);
+            return true;
+        };
+        visitValue(root, 0, match);
+    }
+
+    template <typename Json>
+        requires kIsJsonValue<std::remove_const_t<Json>>
+    std::vector<Json*> select(Json& root) const {
+        std::vector<Json*> matches;
+        forEach(root, [&](Json& value) { matches.push_back(&value); });
+        return matches;
+    }
+
+    // The first match, or nullptr. Stops looking once it is found.
+    template <typename Json>
+        requires kIsJsonValue<std::remove_const_t<Json>>
+    Json* find(Json& root) const {
+        Json* found = nullptr;
+        auto match = [&](Json& value) {
+            found = &value;
+            return false;
+        };
+        visitValue(root, 0, match);
+        return found;
+    }
+
+    // The same over text, without parsing it: values off the path are skipped
+    // by bracket matching, and matches are JsonLazyValues into the text, so
+    // only what is read from them gets parsed. Malformed text on the path
+    // throws as JsonLazyValue does; skipped values are not validated.
+    // Recursive descent reads a value once per level it is nested at.
+    template <typename Callback>
+    void forEach(const JsonLazyValue& root, Callback&& callback) const {
+        auto match = [&](const JsonLazyValue& value) {
+            callback(value);
+            return true;
+        };
+        visitText(root, 0, match, 0);
+    }
+
+    std::vector<JsonLazyValue> select(const JsonLazyValue& root) const {
+        std::vector<JsonLazyValue> matches;
+        forEach(root, [&](const JsonLazyValue& value) { matches.push_back(value); });
+        return matches;
+    }
+
+    std::optional<JsonLazyValue> find(const JsonLazyValue& root) const {
+        std::optional<JsonLazyValue> found;
+        auto match = [&](const JsonLazyValue& value) {
+            found = value;
+            return false;
+        };
+        visitText(root, 0, match, 0);
+        return found;
+    }
+
+private:
+    enum class Kind : uint8_t {
+        Name, // a member
+        Token, // a JSON Pointer reference token: a member, or an element if it is an index
+        Index, // an element
+        Slice,
+        Wildcard // every member or element
+    };
+
+    struct Step {
+        Kind kind = Kind::Name;
+        bool descendant = false; // applies to the value and everything below it
+        std::string name; // Name and Token
+        int64_t index = -1; // Index, and Token if it is an array index
+        std::optional<int64_t> start, end; // Slice
+        int64_t step = 1; // Slice
+    };
+
+    // Indexes and slice bounds are limited to 15 digits, so that stepping
+    // past the end of an array can't overflow.
+    static constexpr size_t kMaxDigits = 15;
+
+    bool compilePointer(std::string_view path, size_t& pos) {
+        while (pos < path.size()) {
+            ++pos; // skip '/'
+            Step step;
+            step.kind = Kind::Token;
+            for (; pos < path.size() && path[pos] != '/'; ++pos) {
+                if (path[pos] != '~') {
+                    step.name += path[pos];
+                } else if (pos + 1 < path.size() && (path[pos + 1] == '0' || path[pos + 1] == '1')) {
+                    step.name += path[++pos] == '0' ? '~' : '/';
+                } else {
+                    return false;
+                }
+            }
+            // Array indexes are "0" or digits without a leading zero
+            const std::string_view digits = step.name;
+            if (!digits.empty() && digits.size() <= kMaxDigits && (digits[0] != '0' || digits.size() == 1)
+                && std::all_of(digits.begin(), digits.end(), [](char c) { return isdigit(c); }))
+                std::from_chars(digits.data(), digits.data() + digits.size(), step.index);
+            steps.push_back(std::move(step));
+        }
+        return true;
+    }
+
+    bool compileExpression(std::string_view path, size_t& pos) {
+        if (path[pos] != '$')
+            return false;
+        ++pos;
+        while (pos < path.size()) {
+            Step step;
+            if (path.substr(pos, 2) == "..") {
+                step.descendant = true;
+                pos += 2;
+            } else if (path[pos] == '.') {
+                ++pos;
+            } else if (path[pos] != '[') {
+                return false;
+            }
+            const bool dotted = path[pos - 1] == '.';
+            if (pos < path.size() && path[pos] == '[' && (step.descendant || !dotted)) {
+                ++pos;
+                if (!compileBracket(path, pos, step))
+                    return false;
+            } else if (pos < path.size() && path[pos] == '*') {
+                step.kind = Kind::Wildcard;
+                ++pos;
+            } else {
+                const size_t start = pos;
+                while (pos < path.size() && (isalnum(static_cast<unsigned char>(path[pos])) || path[pos] == '_' || static_cast<uint8_t>(path[pos]) >= 0x80))
+                    ++pos;
+                if (pos == start)
+                    return false;
+                step.name = path.substr(start, pos - start);
+            }
+            steps.push_back(std::move(step));
+        }
+        return true;
+    }
+
+    // The selector after a '[', up to and including the ']'.
+    static bool compileBracket(std::string_view path, size_t& pos, Step& step) {
+        skipSpaces(path, pos);
+        if (pos < path.size() && (path[pos] == '\'' || path[pos] == '"')) {
+            if (!compileName(path, pos, step.name))
+                return false;
+        } else if (pos < path.size() && path[pos] == '*') {
+            step.kind = Kind::Wildcard;
+            ++pos;
+        } else {
+            std::optional<int64_t> bounds[3];
+            size_t count = 0;
+            do {
+                if (count)
+                    ++pos; // skip ':'
+                skipSpaces(path, pos);
+                if (pos < path.size() && (path[pos] == '-' || isdigit(path[pos]))) {
+                    int64_t n;
+                    const auto [end, ec] = std::from_chars(path.data() + pos, path.data() + path.size(), n);
+                    if (ec != std::errc() || end - (path.data() + pos) > static_cast<ptrdiff_t>(kMaxDigits + (path[pos] == '-')))
+                        return false;
+                    bounds[count] = n;
+                    pos = end - path.data();
+                    skipSpaces(path, pos);
+                }
+            } while (++count < 3 && pos < path.size() && path[pos] == ':');
+            if (count == 1) {
+                if (!bounds[0])
+                    return false;
+                step.kind = Kind::Index;
+                step.index = *bounds[0];
+            } else {
+                step.kind = Kind::Slice;
+                step.start = bounds[0];
+                step.end = bounds[1];
+                step.step = bounds[2].value_or(1);
+            }
+        }
+        skipSpaces(path, pos);
+        if (pos == path.size() || path[pos] != ']')
+            return false;
+        ++pos;
+        return true;
+    }
+
+    // A name in single or double quotes, with the escapes of JSON strings
+    // plus \'.
+    static bool compileName(std::string_view path, size_t& pos, std::string& name) {
+        const char quote = path[pos++];
+        while (pos < path.size() && path[pos] != quote) {
+            if (path[pos] != '\\') {
+                name += path[pos++];
+            } else if (pos + 1 < path.size() && path[pos + 1] == '\'') {
+                name += '\'';
+                pos += 2;
+            } else {
+                JsonErrorCode error = JsonErrorCode::None;
+                ++pos; // skip backslash
+                if (!JsonParser::parseEscape(path, pos, name, error))
+                    return false;
+            }
+        }
+        if (pos == path.size())
+            return false;
+        ++pos; // skip closing quote
+        return true;
+    }
+
+    static void skipSpaces(std::string_view path, size_t& pos) {
+        while (pos < path.size() && isspace(path[pos]))
+            ++pos;
+    }
+
+    // Passes the matches of steps[i] onwards below value to match, until it
+    // returns false.
+    template <typename Json, typename Match>
+    bool visitValue(Json& value, size_t i, Match& match) const {
+        if (i == steps.size())
+            return match(value);
+        const Step& step = steps[i];
+        if (!selectValue(value, step, [&](Json& child) { return visitValue(child, i + 1, match); }))
+            return false;
+        return !step.descendant || forEachChild(value, [&](Json& child) { return visitValue(child, i, match); });
+    }
+
+    // Calls next(child) for the members or elements of value that step
+    // selects, until it returns false.
+    template <typename Json, typename Next>
+    static bool selectValue(Json& value, const Step& step, Next&& next) {
+        using Value = std::remove_const_t<Json>;
+        if (step.kind == Kind::Wildcard)
+            return forEachChild(value, next);
+        if (auto* obj = value.template tryGet<typename Value::Object>()) {
+            if (step.kind != Kind::Name && step.kind != Kind::Token)
+                return true;
+            auto* member = obj->find(step.name);
+            return !member || next(*member);
+        }
+        auto* arr = value.template tryGet<typename Value::Array>();
+        if (!arr || step.kind == Kind::Name)
+            return true;
+        const int64_t size = static_cast<int64_t>(arr->elements.size());
+        if (step.kind == Kind::Slice)
+            return forEachInSlice(step, size, [&](int64_t index) { return next(arr->elements[index]); });
+        const int64_t index = step.kind == Kind::Index && step.index < 0 ? step.index + size : step.index;
+        return index < 0 || index >= size || next(arr->elements[index]);
+    }
+
+    template <typename Json, typename Next>
+    static bool forEachChild(Json& value, Next&& next) {
+        using Value = std::remove_const_t<Json>;
+        if (auto* arr = value.template tryGet<typename Value::Array>()) {
+            for (auto& element : arr->elements) {
+                if (!next(element))
+                    return false;
+            }
+        } else if (auto* obj = value.template tryGet<typename Value::Object>()) {
+            for (auto& member : obj->members) {
+                if (!next(member.second))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // visitValue over text. Descent into nested values is recursive, so it
+    // stops at the maxDepth of the text's options like the parsers.
+    template <typename Match>
+    bool visitText(const JsonLazyValue& value, size_t i, Match& match, size_t depth) const {
+        if (i == steps.size())
+            return match(value);
+        const Step& step = steps[i];
+        if (!selectText(value, step, [&](const JsonLazyValue& child) { return visitText(child, i + 1, match, depth); }))
+            return false;
+        if (!step.descendant || (!value.isArray() && !value.isObject()))
+            return true;
+        if (depth >= value.options.maxDepth)
+            throw std::runtime_error(JsonError::message(JsonErrorCode::DepthLimitExceeded));
+        return forEachChild(value, [&](const JsonLazyValue& child) { return visitText(child, i, match, depth + 1); });
+    }
+
+    template <typename Next>
+    static bool selectText(const JsonLazyValue& value, const Step& step, Next&& next) {
+        if (step.kind == Kind::Wildcard)
+            return forEachChild(value, next);
+        bool more = true;
+        if (value.isObject()) {
+            if (step.kind != Kind::Name && step.kind != Kind::Token)
+                return true;
+            value.scanObject([&](std::string_view rawKey, bool escaped, size_t pos) {
+                if (escaped ? value.decodeKey(rawKey) != step.name : rawKey != step.name)
+                    return true;
+                more = next(value.child(pos));
+                return false;
+            });
+            return more;
+        }
+        if (!value.isArray() || step.kind == Kind::Name || (step.kind == Kind::Token && step.index < 0))
+            return true;
+
+        // Elements counted from the start are selected as the scan passes
+        // them, stopping after the last one
+        const bool slice = step.kind == Kind::Slice;
+        if (slice ? step.step > 0 && step.start.value_or(0) >= 0 && step.end.value_or(0) >= 0 : step.index >= 0) {
+            const int64_t start = slice ? step.start.value_or(0) : step.index;
+            const int64_t end = slice ? step.end.value_or(INT64_MAX) : step.index + 1;
+            const int64_t stride = slice ? step.step : 1;
+            int64_t index = 0;
+            value.scanArray([&](size_t pos) {
+                if (index >= end)
+                    return false;
+                if (index >= start && (index - start) % stride == 0)
+                    more = next(value.child(pos));
+                return more && ++index < end;
+            });
+            return more;
+        }
+
+        // Counting from the end needs the positions of all of them
+        std::vector<size_t> positions;
+        value.scanArray([&](size_t pos) {
+            positions.push_back(pos);
+            return true;
+        });
+        const int64_t size = static_cast<int64_t>(positions.size());
+        if (slice)
+            return forEachInSlice(step, size, [&](int64_t index) { return next(value.child(positions[index])); });
+        const int64_t index = step.index + size;
+        return index < 0 || next(value.child(positions[index]));
+    }
+
+    template <typename Next>
+    static bool forEachChild(const JsonLazyValue& value, Next&& next) {
+        bool more = true;
+        if (value.isArray())
+            value.scanArray([&](size_t pos) { return more = next(value.child(pos)); });
+        else if (value.isObject())
+            value.scanObject([&](std::string_view, bool, size_t pos) { return more = next(value.child(pos)); });
+        return more;
+    }
+
+    // Calls each(index) for the elements a slice selects from an array of
+    // size elements, in order, until it returns false. Bounds are clamped to
+    // the array as RFC 9535 specifies, and a step of 0 selects nothing.
+    template <typename Each>
+    static bool forEachInSlice(const Step& step, int64_t size, Each&& each) {
+        const auto bound = [&](std::optional<int64_t> i, int64_t omitted, int64_t low, int64_t high) {
+            return std::clamp(!i ? omitted : *i < 0 ? *i + size : *i, low, high);
+        };
+        if (step.step > 0) {
+            const int64_t end = bound(step.end, size, 0, size);
+            for (int64_t i = bound(step.start, 0, 0, size); i < end; i += step.step) {
+                if (!each(i))
+                    return false;
+            }
+        } else if (step.step < 0) {
+            const int64_t end = bound(step.end, -1, -1, size - 1);
+            for (int64_t i = bound(step.start, size - 1, -1, size - 1); i > end; i += step.step) {
+                if (!each(i))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<Step> steps;
+};
+
+struct JsonWriteOptions {
+    bool pretty = false; // one member or element per line
+    int indent = 4; // spaces per nesting level when pretty
+};
+
+// Serializes JSON values as UTF-8 text. Output is appended to a sink, which is
+// any type with append(const char*, size_t), such as a reused std::string.
+// Doubles are written in their shortest round-trip form and keep a fractional
+// part, so they parse back as doubles; NaN and infinities become null.
+class JsonWriter {
+public:
+    template <typename Json>
+    static std::string dump(const Json& value, const JsonWriteOptions& options = {}) {
+        std::string out;
+        write(value, out, options);
+        return out;
+    }
+
+    template <typename Json, typename Sink>
+    static void write(const Json& value, Sink& sink, const JsonWriteOptions& options = {}) {
+        writeValue(value, sink, options, 0);
+    }
+
+    // Encodes value as CBOR or MessagePack, for JsonParser::parseBinary.
+    // Integers take the fewest bytes that hold them, and doubles that survive a
+    // round trip through float take four. RawNumber becomes a CBOR bignum; as
+    // MessagePack has none, it is written there as the nearest double.
+    template <typename Json>
+    static std::string dumpBinary(const Json& value, JsonBinaryFormat format) {
+        std::string out;
+        writeBinary(value, out, format);
+        return out;
+    }
+
+    template <typename Json, typename Sink>
+    static void writeBinary(const Json& value, Sink& sink, JsonBinaryFormat format) {
+        if (format == JsonBinaryFormat::Cbor)
+            writeCbor(value, sink);
+        else
+            writeMessagePack(value, sink);
+    }
+
+private:
+    template <typename Json, typename Sink>
+    static void writeValue(const Json& value, Sink& sink, const JsonWriteOptions& options, int depth) {
+        std::visit(
+            [&](const auto& val) {
+                using T = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<T, std::nullptr_t>) {
+                    sink.append("null", 4);
+                } else if constexpr (std::is_same_v<T, bool>) {
+                    val ? sink.append("true", 4) : sink.append("false", 5);
+                } else if constexpr (std::is_same_v<T, double>) {
+                    writeDouble(val, sink);
+                } else if constexpr (std::is_integral_v<T>) {
+                    char buf[24];
+                    const auto result = std::to_chars(buf, buf + sizeof(buf), val);
+                    sink.append(buf, result.ptr - buf);
+                } else if constexpr (std::is_same_v<T, typename Json::RawNumber>) {
+                    sink.append(val.text.data(), val.text.size());
+                } else if constexpr (std::is_same_v<T, typename Json::StringType>) {
+                    writeString(val, sink);
+                } else if constexpr (std::is_same_v<T, typename Json::Array>) {
+                    writeArray<Json>(val, sink, options, depth);
+                } else {
+                    writeObject<Json>(val, sink, options, depth);
+                }
+            },
+            value.value);
+    }
+
+    template <typename Json, typename Sink>
+    static void writeArray(const typename Json::Array& arr, Sink& sink, const JsonWriteOptions& options, int depth) {
+        if (arr.elements.empty()) {
+            sink.append("[]", 2);
+            return;
+        }
+        sink.append("[", 1);
+        bool first = true;
+        for (const auto& element : arr.elements) {
+            if (!first)
+                sink.append(",", 1);
+            first = false;
+            newline(sink, options, depth + 1);
+            writeValue(element, sink, options, depth + 1);
+        }
+        newline(sink, options, depth);
+        sink.append("]", 1);
+    }
+
+    template <typename Json, typename Sink>
+    static void writeObject(const typename Json::Object& obj, Sink& sink, const JsonWriteOptions& options, int depth) {
+        if (obj.members.empty()) {
+            sink.append("{}", 2);
+            return;
+        }
+        sink.append("{", 1);
+        bool first = true;
+        for (const auto& [key, member] : obj.members) {
+            if (!first)
+                sink.append(",", 1);
+            first = false;
+            newline(sink, options, depth + 1);
+            writeString(key, sink);
+            options.pretty ? sink.append(": ", 2) : sink.append(":", 1);
+            writeValue(member, sink, options, depth + 1);
+        }
+        newline(sink, options, depth);
+        sink.append("}", 1);
+    }
+
+    template <typename Sink>
+    static void newline(Sink& sink, const JsonWriteOptions& options, int depth) {
+        if (!options.pretty)
+            return;
+        static constexpr char kSpaces[] = "\n                                ";
+        size_t count = size_t(depth) * options.indent + 1;
+        const char* chunk = kSpaces;
+        while (count > 0) {
+            const size_t n = std::min(count, sizeof(kSpaces) - 1);
+            sink.append(chunk, n);
+            count -= n;
+            chunk = kSpaces + 1; // only the first chunk starts with the newline
+        }
+    }
+
+    template <typename Sink>
+    static void writeString(std::string_view str, Sink& sink) {
+        sink.append("\"", 1);
+        const char* pos = str.data();
+        const char* end = pos + str.size();
+        while (true) {
+            const char* special = JsonSimd::findEscape(pos, end);
+            sink.append(pos, special - pos);
+            if (special == end)
+                break;
+            writeEscape(*special, sink);
+            pos = special + 1;
+        }
+        sink.append("\"", 1);
+    }
+
+    template <typename Sink>
+    static void writeEscape(char c, Sink& sink) {
+        switch (c) {
+        case '"': sink.append("\\\"", 2); break;
+        case '\\': sink.append("\\\\", 2); break;
+        case '\b': sink.append("\\b", 2); break;
+        case '\f': sink.append("\\f", 2); break;
+        case '\n': sink.append("\\n", 2); break;
+        case '\r': sink.append("\\r", 2); break;
+        case '\t': sink.append("\\t", 2); break;
+        default: {
+            static constexpr char kHex[] = "0123456789abcdef";
+            const char escape[] = { '\\', 'u', '0', '0', kHex[(c >> 4) & 0xF], kHex[c & 0xF] };
+            sink.append(escape, sizeof(escape));
+            break;
+        }
+        }
+    }
+
+    template <typename Sink>
+    static void writeDouble(double value, Sink& sink) {
+        if (!std::isfinite(value)) {
+            sink.append("null", 4);
+            return;
+        }
+        char buf[32];
+        const auto result = std::to_chars(buf, buf + sizeof(buf) - 2, value);
+        char* end = result.ptr;
+        if (std::find_if(buf, end, [](char c) { return c == '.' || c == 'e'; }) == end) {
+            *end++ = '.';
+            *end++ = '0';
+        }
+        sink.append(buf, end - buf);
+    }
+
+    template <typename Json, typename Sink>
+    static void writeCbor(const Json& value, Sink& sink) {
+        std::visit(
+            [&](const auto& val) {
+                using T = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<T, std::nullptr_t>) {
+                    writeByte(0xF6, sink);
+                } else if constexpr (std::is_same_v<T, bool>) {
+                    writeByte(val ? 0xF5 : 0xF4, sink);
+                } else if constexpr (std::is_same_v<T, double>) {
+                    if (static_cast<double>(static_cast<float>(val)) == val) {
+                        writeByte(0xFA, sink);
+                        writeBigEndian(std::bit_cast<uint32_t>(static_cast<float>(val)), 4, sink);
+                    } else {
+                        writeByte(0xFB, sink);
+                        writeBigEndian(std::bit_cast<uint64_t>(val), 8, sink);
+                    }
+                } else if constexpr (std::is_integral_v<T>) {
+                    if (val >= 0)
+                        writeCborHead(0, static_cast<uint64_t>(val), sink);
+                    else
+                        writeCborHead(1, ~static_cast<uint64_t>(static_cast<int64_t>(val)), sink); // -1 - val
+                } else if constexpr (std::is_same_v<T, typename Json::RawNumber>) {
+                    const bool negative = !val.text.empty() && val.text.front() == '-';
+                    const std::string magnitude = decimalToBytes(std::string_view(val.text).substr(negative), negative);
+                    writeByte(negative ? 0xC3 : 0xC2, sink); // bignum tags
+                    writeCborHead(2, magnitude.size(), sink);
+                    sink.append(magnitude.data(), magnitude.size());
+                } else if constexpr (std::is_same_v<T, typename Json::StringType>) {
+                    writeCborHead(3, val.size(), sink);
+                    sink.append(val.data(), val.size());
+                } else if constexpr (std::is_same_v<T, typename Json::Array>) {
+                    writeCborHead(4, val.elements.size(), sink);
+                    for (const auto& element : val.elements)
+                        writeCbor(element, sink);
+                } else {
+                    writeCborHead(5, val.members.size(), sink);
+                    for (const auto& [key, member] : val.members) {
+                        writeCborHead(3, key.size(), sink);
+                        sink.append(key.data(), key.size());
+                        writeCbor(member, sink);
+                    }
+                }
+            },
+            value.value);
+    }
+
+    // A major type with its argument in the fewest bytes.
+    template <typename Sink>
+    static void writeCborHead(uint8_t major, uint64_t arg, Sink& sink) {
+        const uint8_t type = static_cast<uint8_t>(major << 5);
+        if (arg < 24) {
+            writeByte(type | static_cast<uint8_t>(arg), sink);
+        } else if (arg <= 0xFF) {
+            writeByte(type | 24, sink);
+            writeBigEndian(arg, 1, sink);
+        } else if (arg <= 0xFFFF) {
+            writeByte(type | 25, sink);
+            writeBigEndian(arg, 2, sink);
+        } else if (arg <= 0xFFFFFFFF) {
+            writeByte(type | 26, sink);
+            writeBigEndian(arg, 4, sink);
+        } else {
+            writeByte(type | 27, sink);
+            writeBigEndian(arg, 8, sink);
+        }
+    }
+
+    // Big-endian bytes of a decimal magnitude, less one if decrement is set.
+    static std::string decimalToBytes(std::string_view digits, bool decrement) {
+        std::string bytes; // little-endian until the end
+        for (const char digit : digits) {
+            unsigned carry = static_cast<unsigned>(digit - '0');
+            for (char& byte : bytes) {
+                const unsigned value = static_cast<uint8_t>(byte) * 10u + carry;
+                byte = static_cast<char>(value & 0xFF);
+                carry = value >> 8;
+            }
+            if (carry)
+                bytes.push_back(static_cast<char>(carry));
+        }
+        for (size_t i = 0; decrement && i < bytes.size(); ++i) {
+            if (static_cast<uint8_t>(bytes[i]--) != 0)
+                break;
+        }
+        while (!bytes.empty() && bytes.back() == 0)
+            bytes.pop_back();
+        std::reverse(bytes.begin(), bytes.end());
+        return bytes;
+    }
+
+    template <typename Json, typename Sink>
+    static void writeMessagePack(const Json& value, Sink& sink) {
+        std::visit(
+            [&](const auto& val) {
+                using T = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<T, std::nullptr_t>) {
+                    writeByte(0xC0, sink);
+                } else if constexpr (std::is_same_v<T, bool>) {
+                    writeByte(val ? 0xC3 : 0xC2, sink);
+                } else if constexpr (std::is_same_v<T, double>) {
+                    writeMessagePackDouble(val, sink);
+                } else if constexpr (std::is_integral_v<T>) {
+                    if (val >= 0)
+                        writeMessagePackUnsigned(static_cast<uint64_t>(val), sink);
+                    else
+                        writeMessagePackNegative(static_cast<int64_t>(val), sink);
+                } else if constexpr (std::is_same_v<T, typename Json::RawNumber>) {
+                    double num = 0;
+                    std::from_chars(val.text.data(), val.text.data() + val.text.size(), num);
+                    writeMessagePackDouble(num, sink);
+                } else if constexpr (std::is_same_v<T, typename Json::StringType>) {
+                    writeMessagePackString(val, sink);
+                } else if constexpr (std::is_same_v<T, typename Json::Array>) {
+                    writeMessagePackHead(0x90, 0xDC, val.elements.size(), sink);
+                    for (const auto& element : val.elements)
+                        writeMessagePack(element, sink);
+                } else {
+                    writeMessagePackHead(0x80, 0xDE, val.members.size(), sink);
+                    for (const auto& [key, member] : val.members) {
+                        writeMessagePackString(key, sink);
+                        writeMessagePack(member, sink);
+                    }
+                }
+            },
+            value.value);
+    }
+
+    template <typename Sink>
+    static void writeMessagePackUnsigned(uint64_t n, Sink& sink) {
+        if (n <= 0x7F) {
+            writeByte(static_cast<uint8_t>(n), sink);
+        } else {
+            const unsigned width = n <= 0xFF ? 0 : n <= 0xFFFF ? 1 : n <= 0xFFFFFFFF ? 2 : 3;
+            writeByte(static_cast<uint8_t>(0xCC + width), sink);
+            writeBigEndian(n, size_t(1) << width, sink);
+        }
+    }
+
+    template <typename Sink>
+    static void writeMessagePackNegative(int64_t n, Sink& sink) {
+        if (n >= -32) {
+            writeByte(static_cast<uint8_t>(n), sink);
+        } else {
+            const unsigned width = n >= INT8_MIN ? 0 : n >= INT16_MIN ? 1 : n >= INT32_MIN ? 2 : 3;
+            writeByte(static_cast<uint8_t>(0xD0 + width), sink);
+            writeBigEndian(static_cast<uint64_t>(n), size_t(1) << width, sink);
+        }
+    }
+
+    template <typename Sink>
+    static void writeMessagePackDouble(double n, Sink& sink) {
+        if (static_cast<double>(static_cast<float>(n)) == n) {
+            writeByte(0xCA, sink);
+            writeBigEndian(std::bit_cast<uint32_t>(static_cast<float>(n)), 4, sink);
+        } else {
+            writeByte(0xCB, sink);
+            writeBigEndian(std::bit_cast<uint64_t>(n), 8, sink);
+        }
+    }
+
+    template <typename Sink>
+    static void writeMessagePackString(std::string_view str, Sink& sink) {
+        if (str.size() < 32) {
+            writeByte(static_cast<uint8_t>(0xA0 | str.size()), sink);
+        } else {
+            const unsigned width = str.size() <= 0xFF ? 0 : str.size() <= 0xFFFF ? 1 : 2;
+            writeByte(static_cast<uint8_t>(0xD9 + width), sink);
+            writeBigEndian(str.size(), size_t(1) << width, sink);
+        }
+        sink.append(str.data(), str.size());
+    }
+
+    // An array or map header: the fix form below 16 entries, then 16 or 32 bits.
+    template <typename Sink>
+    static void writeMessagePackHead(uint8_t fix, uint8_t wide, size_t count, Sink& sink) {
+        if (count < 16) {
+            writeByte(static_cast<uint8_t>(fix | count), sink);
+        } else if (count <= 0xFFFF) {
+            writeByte(wide, sink);
+            writeBigEndian(count, 2, sink);
+        } else {
+            writeByte(static_cast<uint8_t>(wide + 1), sink);
+            writeBigEndian(count, 4, sink);
+        }
+    }
+
+    template <typename Sink>
+    static void writeByte(uint8_t byte, Sink& sink) {
+        const char c = static_cast<char>(byte);
+        sink.append(&c, 1);
+    }
+
+    template <typename Sink>
+    static void writeBigEndian(uint64_t value, size_t bytes, Sink& sink) {
+        char buf[8];
+        for (size_t i = 0; i < bytes; ++i)
+            buf[i] = static_cast<char>(value >> (8 * (bytes - 1 - i)));
+        sink.append(buf, bytes);
+    }
+};
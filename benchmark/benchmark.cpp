@@ -1,6 +1,12 @@
 #include <benchmark/benchmark.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <nlohmann/json.hpp>
 #include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include "../auric_json.h"
 
 const std::string kSmallJson = R"(
@@ -117,12 +123,155 @@ const std::string kLargeJson = R"(
     }
 )";
 
+// A multi-megabyte array of kLargeJson records
+const std::string kHugeJson = [] {
+    std::string json = "[";
+    for (int i = 0; i < 4000; ++i) {
+        json += kLargeJson;
+        json += ",";
+    }
+    json.back() = ']';
+    return json;
+}();
+
+// Rows of IDs, epoch-nanosecond timestamps, counters and measurements
+const std::string kNumbersJson = [] {
+    std::string json = "[";
+    uint64_t state = 88172645463325252u;
+    for (int i = 0; i < 20000; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        json += "[" + std::to_string(state % 10000000000000u) + "," + std::to_string(1700000000000000000u + state % 100000000000000u) + ","
+            + std::to_string(int(state % 1000)) + "," + std::to_string(-int(state % 100000)) + "," + std::to_string(double(state % 1000000) / 1000) + "],";
+    }
+    json.back() = ']';
+    return json;
+}();
+
+// A GeoJSON-style track of [longitude, latitude, elevation] points. Every
+// tenth point is written back from a computed double, with all 17 digits.
+const std::string kCoordinatesJson = [] {
+    std::string json = "[";
+    uint64_t state = 88172645463325252u;
+    char buf[96];
+    for (int i = 0; i < 100000; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        const double lon = -180 + double(state % 360000000) / 1e6, lat = -90 + double(state % 180000000) / 1e6;
+        if (i % 10 == 0)
+            snprintf(buf, sizeof(buf), "[%.17g,%.17g,%.17g],", lon / 3, lat / 7, double(state % 900000) / 100);
+        else
+            snprintf(buf, sizeof(buf), "[%.6f,%.6f,%.2f],", lon, lat, double(state % 900000) / 100);
+        json += buf;
+    }
+    json.back() = ']';
+    return json;
+}();
+
+// Chat messages as ASCII-only serializers write them: every CJK character an
+// escape and every emoji an escaped surrogate pair
+const std::string kEscapedJson = [] {
+    const char* const words[] = { "\\u4f60\\u597d", "\\u4e16\\u754c", "\\ud83d\\ude00", "\\ud83c\\udf89", "ok", "\\u00e9t\\u00e9", "\\ud83d\\udc4d\\ud83c\\udffd" };
+    std::string json = "[";
+    uint64_t state = 88172645463325252u;
+    for (int i = 0; i < 20000; ++i) {
+        json += R"({"user": "user)" + std::to_string(i % 100) + R"(", "text": ")";
+        for (int w = 0; w < 12; ++w) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            json += words[state % std::size(words)];
+            json += ' ';
+        }
+        json += R"("},)";
+    }
+    json.back() = ']';
+    return json;
+}();
+
+// Multi-paragraph message bodies: long strings broken up by the odd escaped
+// newline or quote, so every one takes the decoding path
+const std::string kTextJson = [] {
+    const std::string paragraph = R"(Привет! The build on 世界-7 finished in 42 minutes; see the \"release notes\" for details.\n)"
+                                  R"(Логи доступны здесь, 日志在这里, and the dashboard is linked below.\n\n)";
+    std::string json = "[";
+    for (int i = 0; i < 4000; ++i) {
+        json += R"({"id": )" + std::to_string(i) + R"(, "body": ")";
+        for (int p = 0; p < 1 + i % 6; ++p)
+            json += paragraph;
+        json += R"("},)";
+    }
+    json.back() = ']';
+    return json;
+}();
+
+// Small documents nested as deep as the default depth limit allows
+const std::string kNestedJson = [] {
+    std::string json = "[";
+    for (int i = 0; i < 500; ++i) {
+        std::string level = "[" + std::to_string(i) + R"(, {"id": )" + std::to_string(i) + R"(, "items": )";
+        level.insert(1, R"({"name": "level", "tags": ["a", "b"]}, )");
+        json += level;
+    }
+    json += "[]";
+    for (int i = 0; i < 500; ++i)
+        json += "}]";
+    return json + "]";
+}();
+
+// kHugeJson written to a temporary file, for the file parsing benchmarks
+const std::string kHugeJsonPath = [] {
+    const std::string path = (std::filesystem::temp_directory_path() / "auric_json_benchmark_huge.json").string();
+    std::ofstream(path, std::ios::binary) << kHugeJson;
+    return path;
+}();
+
+// Compact kLargeJson records, one per line
+const std::string kJsonLines = [] {
+    const std::string record = JsonWriter::dump(JsonParser::parse(kLargeJson));
+    std::string ndjson;
+    for (int i = 0; i < 10000; ++i) {
+        ndjson += record;
+        ndjson += '\n';
+    }
+    return ndjson;
+}();
+
+// Counts values and string bytes, standing in for a field-extracting handler
+struct SaxCounter : JsonSaxHandler {
+    size_t values = 0;
+    size_t stringBytes = 0;
+
+    void onNull() { ++values; }
+    void onBool(bool) { ++values; }
+    void onInt(int) { ++values; }
+    void onInt64(int64_t) { ++values; }
+    void onUInt64(uint64_t) { ++values; }
+    void onDouble(double) { ++values; }
+    void onString(std::string_view str) {
+        ++values;
+        stringBytes += str.size();
+    }
+};
+
 static void BM_AuricJson_ParseSmallJson(benchmark::State& state) {
     for (auto _ : state) {
         JsonParser parser;
         JsonValue json = parser.parse(kSmallJson);
         benchmark::DoNotOptimize(json);
     }
+    state.SetBytesProcessed(state.iterations() * kSmallJson.size());
+}
+
+static void BM_AuricJson_ParseIndexedSmallJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonParser parser;
+        JsonValue json = parser.parseIndexed(kSmallJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kSmallJson.size());
 }
 
 static void BM_NlohmannJson_ParseSmallJson(benchmark::State& state) {
@@ -146,6 +295,16 @@ static void BM_AuricJson_ParseMediumJson(benchmark::State& state) {
         JsonValue json = parser.parse(kMediumJson);
         benchmark::DoNotOptimize(json);
     }
+    state.SetBytesProcessed(state.iterations() * kMediumJson.size());
+}
+
+static void BM_AuricJson_ParseIndexedMediumJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonParser parser;
+        JsonValue json = parser.parseIndexed(kMediumJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kMediumJson.size());
 }
 
 static void BM_NlohmannJson_ParseMediumJson(benchmark::State& state) {
@@ -169,6 +328,50 @@ static void BM_AuricJson_ParseLargeJson(benchmark::State& state) {
         JsonValue json = parser.parse(kLargeJson);
         benchmark::DoNotOptimize(json);
     }
+    state.SetBytesProcessed(state.iterations() * kLargeJson.size());
+}
+
+static void BM_AuricJson_ParseIntoLargeJson(benchmark::State& state) {
+    JsonValue json;
+    for (auto _ : state) {
+        JsonParser::parseInto(kLargeJson, json);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kLargeJson.size());
+}
+
+static void BM_AuricJson_ParseDocumentLargeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kLargeJson);
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kLargeJson.size());
+}
+
+static void BM_AuricJson_ParseDocumentBorrowedLargeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kLargeJson, { .borrowStrings = true });
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kLargeJson.size());
+}
+
+static void BM_AuricJson_ParseSaxLargeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonParser::parseSax(kLargeJson, counter);
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kLargeJson.size());
+}
+
+static void BM_AuricJson_ParseIndexedLargeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonParser parser;
+        JsonValue json = parser.parseIndexed(kLargeJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kLargeJson.size());
 }
 
 static void BM_NlohmannJson_ParseLargeJson(benchmark::State& state) {
@@ -186,14 +389,1275 @@ static void BM_RapidJson_ParseLargeJson(benchmark::State& state) {
     }
 }
 
+static void BM_AuricJson_ParseHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonParser parser;
+        JsonValue json = parser.parse(kHugeJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseDocumentHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kHugeJson);
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseDocumentBorrowedHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kHugeJson, { .borrowStrings = true });
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseSaxHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonParser::parseSax(kHugeJson, counter);
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+// The cost of UTF-8 validation: parsing without it, and validating the whole
+// input in a separate pass before parsing without it
+static void BM_AuricJson_ParseSaxHugeJsonUnvalidated(benchmark::State& state) {
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonParser::parseSax(kHugeJson, counter, { .validateUtf8 = false });
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ValidateThenParseSaxHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        if (JsonSimd::validateUtf8(kHugeJson.data(), kHugeJson.data() + kHugeJson.size()) != kHugeJson.data() + kHugeJson.size())
+            state.SkipWithError("invalid UTF-8");
+        SaxCounter counter;
+        JsonParser::parseSax(kHugeJson, counter, { .validateUtf8 = false });
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseDocumentBorrowedHugeJsonUnvalidated(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kHugeJson, { .borrowStrings = true, .validateUtf8 = false });
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseIndexedHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonParser parser;
+        JsonValue json = parser.parseIndexed(kHugeJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_StreamHugeJson(benchmark::State& state) {
+    const size_t chunkSize = state.range(0);
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonStreamParser parser(counter);
+        for (size_t pos = 0; pos < kHugeJson.size(); pos += chunkSize)
+            parser.feed(std::string_view(kHugeJson).substr(pos, chunkSize));
+        parser.finish();
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_StructuralIndexHugeJson(benchmark::State& state) {
+    const auto level = static_cast<JsonSimdLevel>(state.range(0));
+    if (!JsonSimd::isSupported(level)) {
+        state.SkipWithError("SIMD level not supported by this CPU");
+        return;
+    }
+    for (auto _ : state) {
+        auto index = JsonStructuralIndex::build(kHugeJson, level);
+        benchmark::DoNotOptimize(index);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+// The whole parser with its vector kernels forced to one level
+static void BM_AuricJson_ParseSaxHugeJsonAtLevel(benchmark::State& state) {
+    const auto level = static_cast<JsonSimdLevel>(state.range(0));
+    if (!JsonSimd::isSupported(level)) {
+        state.SkipWithError("SIMD level not supported by this CPU");
+        return;
+    }
+    const JsonSimdLevel previous = JsonSimd::activeLevel();
+    JsonSimd::setLevel(level);
+    for (auto _ : state) {
+        SaxCounter handler;
+        JsonParser::parseSax(kHugeJson, handler);
+        benchmark::DoNotOptimize(handler.values);
+    }
+    JsonSimd::setLevel(previous);
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ValidateUtf8HugeJson(benchmark::State& state) {
+    const auto level = static_cast<JsonSimdLevel>(state.range(0));
+    if (!JsonSimd::isSupported(level)) {
+        state.SkipWithError("SIMD level not supported by this CPU");
+        return;
+    }
+    for (auto _ : state) {
+        const char* invalid = JsonSimd::validateUtf8(kHugeJson.data(), kHugeJson.data() + kHugeJson.size(), level);
+        benchmark::DoNotOptimize(invalid);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_NlohmannJson_ParseHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        nlohmann::json json = nlohmann::json::parse(kHugeJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_RapidJson_ParseHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        rapidjson::Document json;
+        json.Parse(kHugeJson.c_str());
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_WriteMediumJson(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(kMediumJson);
+    const JsonWriteOptions options { .pretty = state.range(0) != 0 };
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        JsonWriter::write(json, out, options);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+static void BM_NlohmannJson_WriteMediumJson(benchmark::State& state) {
+    const nlohmann::json json = nlohmann::json::parse(kMediumJson);
+    const int indent = state.range(0) != 0 ? 4 : -1;
+    std::string out;
+    for (auto _ : state) {
+        out = json.dump(indent);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+static void BM_RapidJson_WriteMediumJson(benchmark::State& state) {
+    rapidjson::Document json;
+    json.Parse(kMediumJson.c_str());
+    rapidjson::StringBuffer buffer;
+    for (auto _ : state) {
+        buffer.Clear();
+        if (state.range(0) != 0) {
+            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+            json.Accept(writer);
+        } else {
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            json.Accept(writer);
+        }
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.GetSize());
+}
+
+static void BM_AuricJson_WriteLargeJson(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(kLargeJson);
+    const JsonWriteOptions options { .pretty = state.range(0) != 0 };
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        JsonWriter::write(json, out, options);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+static void BM_NlohmannJson_WriteLargeJson(benchmark::State& state) {
+    const nlohmann::json json = nlohmann::json::parse(kLargeJson);
+    const int indent = state.range(0) != 0 ? 4 : -1;
+    std::string out;
+    for (auto _ : state) {
+        out = json.dump(indent);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+static void BM_RapidJson_WriteLargeJson(benchmark::State& state) {
+    rapidjson::Document json;
+    json.Parse(kLargeJson.c_str());
+    rapidjson::StringBuffer buffer;
+    for (auto _ : state) {
+        buffer.Clear();
+        if (state.range(0) != 0) {
+            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+            json.Accept(writer);
+        } else {
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            json.Accept(writer);
+        }
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.GetSize());
+}
+
+static void BM_AuricJson_WriteHugeJson(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(kHugeJson);
+    const JsonWriteOptions options { .pretty = state.range(0) != 0 };
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        JsonWriter::write(json, out, options);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+static void BM_NlohmannJson_WriteHugeJson(benchmark::State& state) {
+    const nlohmann::json json = nlohmann::json::parse(kHugeJson);
+    const int indent = state.range(0) != 0 ? 4 : -1;
+    std::string out;
+    for (auto _ : state) {
+        out = json.dump(indent);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+static void BM_RapidJson_WriteHugeJson(benchmark::State& state) {
+    rapidjson::Document json;
+    json.Parse(kHugeJson.c_str());
+    rapidjson::StringBuffer buffer;
+    for (auto _ : state) {
+        buffer.Clear();
+        if (state.range(0) != 0) {
+            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+            json.Accept(writer);
+        } else {
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            json.Accept(writer);
+        }
+        benchmark::DoNotOptimize(buffer);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.GetSize());
+}
+
+// An object with n members, as in configuration files with thousands of keys.
+static std::string makeWideObjectJson(size_t n) {
+    std::string json = "{";
+    for (size_t i = 0; i < n; ++i) {
+        json += (i ? ", \"setting." : "\"setting.") + std::to_string(i) + "\": " + std::to_string(i);
+    }
+    return json + "}";
+}
+
+static std::vector<std::string> makeWideObjectKeys(size_t n) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < n; ++i) {
+        keys.push_back("setting." + std::to_string((i * 7919) % n));
+    }
+    return keys;
+}
+
+static void BM_AuricJson_LookupWideObject(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(makeWideObjectJson(state.range(0)), { .indexObjects = true });
+    const auto& obj = std::get<JsonValue::Object>(json.value);
+    const auto keys = makeWideObjectKeys(state.range(0));
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            benchmark::DoNotOptimize(obj[key]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// The plain scan over members that lookups used before objects were indexed.
+static void BM_AuricJson_LookupWideObjectLinear(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(makeWideObjectJson(state.range(0)));
+    const auto& obj = std::get<JsonValue::Object>(json.value);
+    const auto keys = makeWideObjectKeys(state.range(0));
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            benchmark::DoNotOptimize(std::find_if(obj.members.begin(), obj.members.end(), [&](const auto& member) {
+                return member.first == key;
+            }));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+static void BM_NlohmannJson_LookupWideObject(benchmark::State& state) {
+    const nlohmann::json json = nlohmann::json::parse(makeWideObjectJson(state.range(0)));
+    const auto keys = makeWideObjectKeys(state.range(0));
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            benchmark::DoNotOptimize(json[key]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+static void BM_RapidJson_LookupWideObject(benchmark::State& state) {
+    rapidjson::Document json;
+    json.Parse(makeWideObjectJson(state.range(0)).c_str());
+    const auto keys = makeWideObjectKeys(state.range(0));
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            benchmark::DoNotOptimize(json[key.c_str()]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// Variants of kLargeJson broken at different depths: truncated, or with a
+// stray character replacing a delimiter.
+const std::vector<std::string> kMalformedJson = [] {
+    std::vector<std::string> inputs;
+    for (size_t i = 1; i < 8; ++i) {
+        const size_t pos = kLargeJson.size() * i / 8;
+        inputs.push_back(kLargeJson.substr(0, pos));
+        std::string broken = kLargeJson;
+        broken[broken.find_first_of(",:", pos)] = '#';
+        inputs.push_back(std::move(broken));
+    }
+    return inputs;
+}();
+
+static size_t malformedBytes() {
+    size_t bytes = 0;
+    for (const auto& json : kMalformedJson)
+        bytes += json.size();
+    return bytes;
+}
+
+static void BM_AuricJson_RejectMalformedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& json : kMalformedJson) {
+            auto result = JsonParser::tryParse(json);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kMalformedJson.size());
+    state.SetBytesProcessed(state.iterations() * malformedBytes());
+}
+
+static void BM_AuricJson_RejectMalformedJsonThrowing(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& json : kMalformedJson) {
+            try {
+                auto value = JsonParser::parse(json);
+                benchmark::DoNotOptimize(value);
+            } catch (const std::runtime_error& e) {
+                benchmark::DoNotOptimize(e);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kMalformedJson.size());
+    state.SetBytesProcessed(state.iterations() * malformedBytes());
+}
+
+static void BM_NlohmannJson_RejectMalformedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& json : kMalformedJson) {
+            nlohmann::json value = nlohmann::json::parse(json, nullptr, false);
+            benchmark::DoNotOptimize(value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kMalformedJson.size());
+    state.SetBytesProcessed(state.iterations() * malformedBytes());
+}
+
+static void BM_RapidJson_RejectMalformedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& json : kMalformedJson) {
+            rapidjson::Document value;
+            value.Parse(json.c_str(), json.size());
+            benchmark::DoNotOptimize(value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kMalformedJson.size());
+    state.SetBytesProcessed(state.iterations() * malformedBytes());
+}
+
+static void BM_AuricJson_ParseNumbersJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonValue json = JsonParser::parse(kNumbersJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kNumbersJson.size());
+}
+
+static void BM_AuricJson_ParseDocumentNumbersJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kNumbersJson);
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kNumbersJson.size());
+}
+
+static void BM_AuricJson_ParseSaxNumbersJson(benchmark::State& state) {
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonParser::parseSax(kNumbersJson, counter);
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kNumbersJson.size());
+}
+
+static void BM_NlohmannJson_ParseNumbersJson(benchmark::State& state) {
+    for (auto _ : state) {
+        nlohmann::json json = nlohmann::json::parse(kNumbersJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kNumbersJson.size());
+}
+
+static void BM_RapidJson_ParseNumbersJson(benchmark::State& state) {
+    for (auto _ : state) {
+        rapidjson::Document json;
+        json.Parse(kNumbersJson.c_str());
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kNumbersJson.size());
+}
+
+// Reads a few fields from each part of a kLargeJson record the way a handler
+// would, through the copying toX accessors
+static void BM_AuricJson_AccessLargeJsonCopying(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(kLargeJson);
+    for (auto _ : state) {
+        size_t total = json.toObject()["name"].toString().size();
+        total += json.toObject()["spouse"].toObject()["age"].toInt();
+        for (const JsonValue& child : json.toObject()["children"].toArray().elements)
+            total += child.toObject()["hobbies"].toArray().elements.size();
+        for (const JsonValue& job : json.toObject()["workExperience"].toArray().elements)
+            total += job.toObject()["company"].toString().size() + job.toObject()["responsibilities"].toArray().elements.size();
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+// The same reads through the reference accessors
+static void BM_AuricJson_AccessLargeJsonByReference(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(kLargeJson);
+    for (auto _ : state) {
+        const JsonValue::Object& root = json.asObject();
+        size_t total = root["name"].asStringView().size();
+        total += root["spouse"].asObject()["age"].toInt();
+        for (const JsonValue& child : root["children"].asArray().elements)
+            total += child.asObject()["hobbies"].asArray().elements.size();
+        for (const JsonValue& job : root["workExperience"].asArray().elements)
+            total += job.asObject()["company"].asStringView().size() + job.asObject()["responsibilities"].asArray().elements.size();
+        benchmark::DoNotOptimize(total);
+    }
+}
+
+static void BM_AuricJson_ParseCoordinatesJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonValue json = JsonParser::parse(kCoordinatesJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kCoordinatesJson.size());
+}
+
+static void BM_AuricJson_ParseSaxCoordinatesJson(benchmark::State& state) {
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonParser::parseSax(kCoordinatesJson, counter);
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kCoordinatesJson.size());
+}
+
+static void BM_NlohmannJson_ParseCoordinatesJson(benchmark::State& state) {
+    for (auto _ : state) {
+        nlohmann::json json = nlohmann::json::parse(kCoordinatesJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kCoordinatesJson.size());
+}
+
+// Full precision, since RapidJSON's default parsing may be off by an ulp
+static void BM_RapidJson_ParseCoordinatesJson(benchmark::State& state) {
+    for (auto _ : state) {
+        rapidjson::Document json;
+        json.Parse<rapidjson::kParseFullPrecisionFlag>(kCoordinatesJson.c_str());
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kCoordinatesJson.size());
+}
+
+static void BM_AuricJson_WriteCoordinatesJson(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(kCoordinatesJson);
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        JsonWriter::write(json, out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * out.size());
+}
+
+static void BM_AuricJson_ParseEscapedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonValue json = JsonParser::parse(kEscapedJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kEscapedJson.size());
+}
+
+static void BM_AuricJson_ParseSaxEscapedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonParser::parseSax(kEscapedJson, counter);
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kEscapedJson.size());
+}
+
+static void BM_NlohmannJson_ParseEscapedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        nlohmann::json json = nlohmann::json::parse(kEscapedJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kEscapedJson.size());
+}
+
+static void BM_RapidJson_ParseEscapedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        rapidjson::Document json;
+        json.Parse(kEscapedJson.c_str());
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kEscapedJson.size());
+}
+
+static void BM_AuricJson_ParseTextJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonValue json = JsonParser::parse(kTextJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kTextJson.size());
+}
+
+static void BM_AuricJson_ParseSaxTextJson(benchmark::State& state) {
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonParser::parseSax(kTextJson, counter);
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kTextJson.size());
+}
+
+static void BM_NlohmannJson_ParseTextJson(benchmark::State& state) {
+    for (auto _ : state) {
+        nlohmann::json json = nlohmann::json::parse(kTextJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kTextJson.size());
+}
+
+static void BM_AuricJson_ParseNestedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonValue json = JsonParser::parse(kNestedJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kNestedJson.size());
+}
+
+static void BM_AuricJson_ParseSaxNestedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        SaxCounter counter;
+        JsonParser::parseSax(kNestedJson, counter);
+        benchmark::DoNotOptimize(counter);
+    }
+    state.SetBytesProcessed(state.iterations() * kNestedJson.size());
+}
+
+static void BM_NlohmannJson_ParseNestedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        nlohmann::json json = nlohmann::json::parse(kNestedJson);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kNestedJson.size());
+}
+
+static void BM_RapidJson_ParseNestedJson(benchmark::State& state) {
+    for (auto _ : state) {
+        rapidjson::Document json;
+        json.Parse(kNestedJson.c_str());
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * kNestedJson.size());
+}
+
+static void BM_AuricJson_SplitJsonLines(benchmark::State& state) {
+    for (auto _ : state) {
+        auto records = JsonLinesParser::split(kJsonLines);
+        benchmark::DoNotOptimize(records);
+    }
+    state.SetBytesProcessed(state.iterations() * kJsonLines.size());
+}
+
+// One line at a time through JsonParser::parse, as callers did by hand
+static void BM_AuricJson_ParseJsonLinesSequential(benchmark::State& state) {
+    for (auto _ : state) {
+        std::string_view rest = kJsonLines;
+        while (!rest.empty()) {
+            const size_t end = std::min(rest.find('\n'), rest.size());
+            JsonValue json = JsonParser::parse(rest.substr(0, end));
+            benchmark::DoNotOptimize(json);
+            rest.remove_prefix(std::min(end + 1, rest.size()));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * kJsonLines.size());
+}
+
+// The same, recycling one value's storage across the records
+static void BM_AuricJson_ParseIntoJsonLinesSequential(benchmark::State& state) {
+    JsonValue json;
+    for (auto _ : state) {
+        std::string_view rest = kJsonLines;
+        while (!rest.empty()) {
+            const size_t end = std::min(rest.find('\n'), rest.size());
+            JsonParser::parseInto(rest.substr(0, end), json);
+            benchmark::DoNotOptimize(json);
+            rest.remove_prefix(std::min(end + 1, rest.size()));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * kJsonLines.size());
+}
+
+static void BM_AuricJson_ParseJsonLines(benchmark::State& state) {
+    JsonLinesParser parser(state.range(0));
+    for (auto _ : state) {
+        auto results = parser.parse(kJsonLines);
+        benchmark::DoNotOptimize(results);
+    }
+    state.SetBytesProcessed(state.iterations() * kJsonLines.size());
+}
+
+static void BM_AuricJson_ForEachJsonLines(benchmark::State& state) {
+    JsonLinesParser parser(state.range(0));
+    for (auto _ : state) {
+        size_t values = 0;
+        parser.forEach(kJsonLines, [&](std::string_view, JsonResult<JsonValue>&& result) {
+            values += result.hasValue();
+        });
+        benchmark::DoNotOptimize(values);
+    }
+    state.SetBytesProcessed(state.iterations() * kJsonLines.size());
+}
+
+static void BM_NlohmannJson_ParseJsonLinesSequential(benchmark::State& state) {
+    for (auto _ : state) {
+        std::string_view rest = kJsonLines;
+        while (!rest.empty()) {
+            const size_t end = std::min(rest.find('\n'), rest.size());
+            nlohmann::json json = nlohmann::json::parse(rest.substr(0, end));
+            benchmark::DoNotOptimize(json);
+            rest.remove_prefix(std::min(end + 1, rest.size()));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * kJsonLines.size());
+}
+
+static void BM_AuricJson_ReadFileThenParseHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        std::ifstream file(kHugeJsonPath, std::ios::binary);
+        std::string json(std::filesystem::file_size(kHugeJsonPath), '\0');
+        file.read(json.data(), json.size());
+        JsonDocument doc = JsonParser::parseDocument(json, { .borrowStrings = true });
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseFileHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseFile(kHugeJsonPath);
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+// Sparse access: a few fields of three records, or one field of every record
+static void BM_AuricJson_LazyAccessHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        JsonLazyValue root(kHugeJson);
+        int64_t sum = root[0]["age"].toInt() + root[2000]["spouse"]["age"].toInt();
+        benchmark::DoNotOptimize(sum);
+        std::string name = root[3999]["children"][1]["name"].toString();
+        benchmark::DoNotOptimize(name);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseThenAccessHugeJson(benchmark::State& state) {
+    using Value = JsonDocument::Value;
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kHugeJson, { .borrowStrings = true });
+        const auto& records = *doc.root().tryGet<Value::Array>();
+        const auto& spouse = (*records[2000].tryGet<Value::Object>())["spouse"];
+        int64_t sum = (*records[0].tryGet<Value::Object>())["age"].toInt() + (*spouse.tryGet<Value::Object>())["age"].toInt();
+        benchmark::DoNotOptimize(sum);
+        const auto& children = *(*records[3999].tryGet<Value::Object>())["children"].tryGet<Value::Array>();
+        std::string name((*children[1].tryGet<Value::Object>())["name"].toString());
+        benchmark::DoNotOptimize(name);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_NlohmannJson_ParseThenAccessHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        const nlohmann::json root = nlohmann::json::parse(kHugeJson);
+        int64_t sum = root[0]["age"].get<int>() + root[2000]["spouse"]["age"].get<int>();
+        benchmark::DoNotOptimize(sum);
+        std::string name = root[3999]["children"][1]["name"].get<std::string>();
+        benchmark::DoNotOptimize(name);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_LazyProjectHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        int64_t sum = 0;
+        JsonLazyValue(kHugeJson).forEachElement([&](JsonLazyValue record) { sum += record["age"].toInt(); });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseThenProjectHugeJson(benchmark::State& state) {
+    using Value = JsonDocument::Value;
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kHugeJson, { .borrowStrings = true });
+        int64_t sum = 0;
+        for (const auto& record : doc.root().tryGet<Value::Array>()->elements)
+            sum += (*record.tryGet<Value::Object>())["age"].toInt();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+// A compiled path over every record: evaluated on the text, or on a tree
+static void BM_AuricJson_LazyPathHugeJson(benchmark::State& state) {
+    const JsonPath path = JsonPath::compile("$[*].children[*].name");
+    for (auto _ : state) {
+        size_t bytes = 0;
+        path.forEach(JsonLazyValue(kHugeJson), [&](const JsonLazyValue& name) { bytes += name.toString().size(); });
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseThenPathHugeJson(benchmark::State& state) {
+    const JsonPath path = JsonPath::compile("$[*].children[*].name");
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseDocument(kHugeJson, { .borrowStrings = true });
+        size_t bytes = 0;
+        path.forEach(doc.root(), [&](const JsonDocument::Value& name) { bytes += name.asStringView().size(); });
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+// Visits every value of a tree or tape, summing string bytes and numbers
+template <typename Json>
+static size_t walk(const Json& value) {
+    if (const auto* arr = value.template tryGet<typename Json::Array>()) {
+        size_t sum = 0;
+        for (const auto& element : arr->elements)
+            sum += walk(element);
+        return sum;
+    }
+    if (const auto* obj = value.template tryGet<typename Json::Object>()) {
+        size_t sum = 0;
+        for (const auto& [key, member] : obj->members)
+            sum += key.size() + walk(member);
+        return sum;
+    }
+    if (const auto* str = value.template tryGet<typename Json::StringType>())
+        return str->size();
+    if (const int* n = value.template tryGet<int>())
+        return static_cast<size_t>(*n);
+    return 1;
+}
+
+static size_t walk(JsonTapeView value) {
+    size_t sum = 0;
+    switch (value.type()) {
+    case JsonTapeType::StartArray: value.forEachElement([&](JsonTapeView element) { sum += walk(element); }); return sum;
+    case JsonTapeType::StartObject:
+        value.forEachMember([&](std::string_view key, JsonTapeView member) { sum += key.size() + walk(member); });
+        return sum;
+    case JsonTapeType::String: return value.toString().size();
+    case JsonTapeType::Int: return static_cast<size_t>(value.toInt());
+    default: return 1;
+    }
+}
+
+// Counts the bytes a JsonDocument arena takes from upstream
+struct CountingResource : std::pmr::memory_resource {
+    size_t allocated = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+static void BM_AuricJson_ParseTapeHugeJson(benchmark::State& state) {
+    size_t memory = 0;
+    for (auto _ : state) {
+        JsonTape tape = JsonParser::parseTape(kHugeJson);
+        memory = tape.memoryUsage();
+        benchmark::DoNotOptimize(tape);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+    state.counters["memory"] = static_cast<double>(memory);
+}
+
+static void BM_AuricJson_ParseDocumentMemoryHugeJson(benchmark::State& state) {
+    size_t memory = 0;
+    for (auto _ : state) {
+        CountingResource upstream;
+        JsonDocument doc(4096, &upstream);
+        JsonParser::parseDocument(kHugeJson, doc);
+        memory = upstream.allocated;
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+    state.counters["memory"] = static_cast<double>(memory);
+}
+
+static void BM_AuricJson_WalkTapeHugeJson(benchmark::State& state) {
+    const JsonTape tape = JsonParser::parseTape(kHugeJson);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(walk(tape.root()));
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_WalkTreeHugeJson(benchmark::State& state) {
+    const JsonValue json = JsonParser::parse(kHugeJson);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(walk(json));
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_WalkDocumentHugeJson(benchmark::State& state) {
+    const JsonDocument doc = JsonParser::parseDocument(kHugeJson);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(walk(doc.root()));
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+// A default configuration with lookup tables, of the kind services embed and
+// parse at startup; parseStatic does that at compile time instead.
+static constexpr JsonLiteral kConfigJson = R"(
+    {
+        "server": {"host": "0.0.0.0", "port": 8080, "workers": 4, "backlog": 511, "keepAlive": true, "timeout": 30.5},
+        "limits": {"maxBodyBytes": 10485760, "maxHeaders": 100, "maxConnections": 10000, "rateLimit": null},
+        "statusText": {
+            "100": "Continue",
+            "101": "Switching Protocols",
+            "200": "OK",
+            "201": "Created",
+            "202": "Accepted",
+            "204": "No Content",
+            "206": "Partial Content",
+            "301": "Moved Permanently",
+            "302": "Found",
+            "303": "See Other",
+            "304": "Not Modified",
+            "307": "Temporary Redirect",
+            "308": "Permanent Redirect",
+            "400": "Bad Request",
+            "401": "Unauthorized",
+            "403": "Forbidden",
+            "404": "Not Found",
+            "405": "Method Not Allowed",
+            "408": "Request Timeout",
+            "409": "Conflict",
+            "410": "Gone",
+            "413": "Content Too Large",
+            "415": "Unsupported Media Type",
+            "429": "Too Many Requests",
+            "500": "Internal Server Error",
+            "501": "Not Implemented",
+            "502": "Bad Gateway",
+            "503": "Service Unavailable",
+            "504": "Gateway Timeout"
+        },
+        "mimeTypes": {
+            "html": "text/html",
+            "css": "text/css",
+            "js": "text/javascript",
+            "json": "application/json",
+            "png": "image/png",
+            "jpg": "image/jpeg",
+            "gif": "image/gif",
+            "svg": "image/svg+xml",
+            "ico": "image/x-icon",
+            "txt": "text/plain",
+            "pdf": "application/pdf",
+            "wasm": "application/wasm",
+            "woff2": "font/woff2",
+            "mp4": "video/mp4",
+            "zip": "application/zip"
+        },
+        "retryBackoffMs": [100, 200, 400, 800, 1600, 3200]
+    }
+)";
+
+static size_t lookupConfig(JsonTapeView config) {
+    return config["server"]["port"].toInt() + config["statusText"]["404"].toString().size() + config["mimeTypes"]["json"].toString().size();
+}
+
+static void BM_AuricJson_ParseTapeConfigJson(benchmark::State& state) {
+    for (auto _ : state) {
+        const JsonTape config = JsonParser::parseTape(kConfigJson.view());
+        benchmark::DoNotOptimize(lookupConfig(config.root()));
+    }
+    state.SetBytesProcessed(state.iterations() * kConfigJson.view().size());
+}
+
+static void BM_AuricJson_ParseStaticConfigJson(benchmark::State& state) {
+    static constexpr auto config = JsonParser::parseStatic<kConfigJson>();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(lookupConfig(config.root()));
+    state.SetBytesProcessed(state.iterations() * kConfigJson.view().size());
+}
+
+// kLargeJson records as typed structs, for parseAs against DOM-then-copy
+struct Relative {
+    std::string name;
+    int age = 0;
+    double height = 0;
+    std::vector<std::string> hobbies;
+};
+
+template <>
+struct JsonFields<Relative> {
+    static constexpr std::tuple fields { JsonField { "name", &Relative::name }, JsonField { "age", &Relative::age },
+        JsonField { "height", &Relative::height }, JsonField { "hobbies", &Relative::hobbies } };
+};
+
+struct Job {
+    std::string company;
+    std::string position;
+    std::string startDate;
+    std::optional<std::string> endDate;
+    std::vector<std::string> responsibilities;
+};
+
+template <>
+struct JsonFields<Job> {
+    static constexpr std::tuple fields { JsonField { "company", &Job::company }, JsonField { "position", &Job::position },
+        JsonField { "startDate", &Job::startDate }, JsonField { "endDate", &Job::endDate }, JsonField { "responsibilities", &Job::responsibilities } };
+};
+
+struct Education {
+    std::string degree;
+    std::string major;
+    std::string university;
+    int graduationYear = 0;
+};
+
+template <>
+struct JsonFields<Education> {
+    static constexpr std::tuple fields { JsonField { "degree", &Education::degree }, JsonField { "major", &Education::major },
+        JsonField { "university", &Education::university }, JsonField { "graduationYear", &Education::graduationYear } };
+};
+
+struct Profile {
+    std::string name;
+    int age = 0;
+    double height = 0;
+    bool married = false;
+    Relative spouse;
+    std::vector<Relative> children;
+    std::vector<Relative> parents;
+    std::vector<Job> workExperience;
+    Education education;
+    std::vector<std::string> skills;
+    std::vector<std::string> languages;
+    std::vector<std::string> hobbies;
+    std::vector<double> favoriteNumbers;
+    std::vector<std::string> favoriteColors;
+    std::vector<std::string> favoriteFoods;
+};
+
+template <>
+struct JsonFields<Profile> {
+    static constexpr std::tuple fields { JsonField { "name", &Profile::name }, JsonField { "age", &Profile::age },
+        JsonField { "height", &Profile::height }, JsonField { "married", &Profile::married }, JsonField { "spouse", &Profile::spouse },
+        JsonField { "children", &Profile::children }, JsonField { "parents", &Profile::parents },
+        JsonField { "workExperience", &Profile::workExperience }, JsonField { "education", &Profile::education },
+        JsonField { "skills", &Profile::skills }, JsonField { "languages", &Profile::languages }, JsonField { "hobbies", &Profile::hobbies },
+        JsonField { "favoriteNumbers", &Profile::favoriteNumbers }, JsonField { "favoriteColors", &Profile::favoriteColors },
+        JsonField { "favoriteFoods", &Profile::favoriteFoods } };
+};
+
+// The hand-written copy out of a JsonValue that parseAs replaces
+static const JsonValue::Array& arrayOf(const JsonValue& value) {
+    if (const auto* arr = value.tryGet<JsonValue::Array>())
+        return *arr;
+    throw std::runtime_error("Value is not an array");
+}
+
+static const JsonValue::Object& objectOf(const JsonValue& value) {
+    if (const auto* obj = value.tryGet<JsonValue::Object>())
+        return *obj;
+    throw std::runtime_error("Value is not an object");
+}
+
+static std::vector<std::string> stringsFromDom(const JsonValue& value) {
+    std::vector<std::string> out;
+    for (const auto& element : arrayOf(value).elements)
+        out.push_back(element.toString());
+    return out;
+}
+
+static Relative relativeFromDom(const JsonValue& value) {
+    const auto& obj = objectOf(value);
+    return { obj["name"].toString(), obj["age"].toInt(), obj["height"].toDouble(), stringsFromDom(obj["hobbies"]) };
+}
+
+static Profile profileFromDom(const JsonValue& value) {
+    const auto& obj = objectOf(value);
+    Profile profile;
+    profile.name = obj["name"].toString();
+    profile.age = obj["age"].toInt();
+    profile.height = obj["height"].toDouble();
+    profile.married = obj["married"].toBool();
+    profile.spouse = relativeFromDom(obj["spouse"]);
+    for (const auto& child : arrayOf(obj["children"]).elements)
+        profile.children.push_back(relativeFromDom(child));
+    for (const auto& parent : arrayOf(obj["parents"]).elements)
+        profile.parents.push_back(relativeFromDom(parent));
+    for (const auto& element : arrayOf(obj["workExperience"]).elements) {
+        const auto& job = objectOf(element);
+        std::optional<std::string> endDate;
+        if (!job["endDate"].isNull())
+            endDate = job["endDate"].toString();
+        profile.workExperience.push_back({ job["company"].toString(), job["position"].toString(), job["startDate"].toString(), endDate,
+            stringsFromDom(job["responsibilities"]) });
+    }
+    const auto& education = objectOf(obj["education"]);
+    profile.education = { education["degree"].toString(), education["major"].toString(), education["university"].toString(),
+        education["graduationYear"].toInt() };
+    profile.skills = stringsFromDom(obj["skills"]);
+    profile.languages = stringsFromDom(obj["languages"]);
+    profile.hobbies = stringsFromDom(obj["hobbies"]);
+    for (const auto& n : arrayOf(obj["favoriteNumbers"]).elements)
+        profile.favoriteNumbers.push_back(n.isInt() ? n.toInt() : n.toDouble());
+    profile.favoriteColors = stringsFromDom(obj["favoriteColors"]);
+    profile.favoriteFoods = stringsFromDom(obj["favoriteFoods"]);
+    return profile;
+}
+
+static void BM_AuricJson_ParseAsHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        auto profiles = JsonParser::parseAs<std::vector<Profile>>(kHugeJson);
+        benchmark::DoNotOptimize(profiles);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+static void BM_AuricJson_ParseThenCopyHugeJson(benchmark::State& state) {
+    for (auto _ : state) {
+        const JsonValue json = JsonParser::parse(kHugeJson);
+        std::vector<Profile> profiles;
+        for (const auto& record : arrayOf(json).elements)
+            profiles.push_back(profileFromDom(record));
+        benchmark::DoNotOptimize(profiles);
+    }
+    state.SetBytesProcessed(state.iterations() * kHugeJson.size());
+}
+
+// Decoding a cached binary encoding against re-parsing the JSON text
+static void BM_AuricJson_ParseBinary(benchmark::State& state, const std::string& json, JsonBinaryFormat format) {
+    const std::string bytes = JsonWriter::dumpBinary(JsonParser::parse(json), format);
+    for (auto _ : state) {
+        JsonValue value = JsonParser::parseBinary(bytes, format);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetBytesProcessed(state.iterations() * json.size());
+    state.counters["encoded"] = static_cast<double>(bytes.size());
+}
+
+static void BM_AuricJson_ParseBinaryDocument(benchmark::State& state, const std::string& json, JsonBinaryFormat format) {
+    const std::string bytes = JsonWriter::dumpBinary(JsonParser::parse(json), format);
+    for (auto _ : state) {
+        JsonDocument doc = JsonParser::parseBinaryDocument(bytes, format, { .borrowStrings = true });
+        benchmark::DoNotOptimize(doc);
+    }
+    state.SetBytesProcessed(state.iterations() * json.size());
+}
+
+static void BM_AuricJson_WriteBinary(benchmark::State& state, const std::string& json, JsonBinaryFormat format) {
+    const JsonValue value = JsonParser::parse(json);
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        JsonWriter::writeBinary(value, out, format);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetBytesProcessed(state.iterations() * json.size());
+}
+
 BENCHMARK(BM_AuricJson_ParseSmallJson);
+BENCHMARK(BM_AuricJson_ParseIndexedSmallJson);
 BENCHMARK(BM_NlohmannJson_ParseSmallJson);
 BENCHMARK(BM_RapidJson_ParseSmallJson);
 BENCHMARK(BM_AuricJson_ParseMediumJson);
+BENCHMARK(BM_AuricJson_ParseIndexedMediumJson);
 BENCHMARK(BM_NlohmannJson_ParseMediumJson);
 BENCHMARK(BM_RapidJson_ParseMediumJson);
 BENCHMARK(BM_AuricJson_ParseLargeJson);
+BENCHMARK(BM_AuricJson_ParseIntoLargeJson);
+BENCHMARK(BM_AuricJson_ParseIndexedLargeJson);
+BENCHMARK(BM_AuricJson_ParseDocumentLargeJson);
+BENCHMARK(BM_AuricJson_ParseDocumentBorrowedLargeJson);
+BENCHMARK(BM_AuricJson_ParseSaxLargeJson);
 BENCHMARK(BM_NlohmannJson_ParseLargeJson);
 BENCHMARK(BM_RapidJson_ParseLargeJson);
+BENCHMARK(BM_AuricJson_ParseHugeJson);
+BENCHMARK(BM_AuricJson_ParseIndexedHugeJson);
+BENCHMARK(BM_AuricJson_ParseDocumentHugeJson);
+BENCHMARK(BM_AuricJson_ParseDocumentBorrowedHugeJson);
+BENCHMARK(BM_AuricJson_ParseDocumentBorrowedHugeJsonUnvalidated);
+BENCHMARK(BM_AuricJson_ParseSaxHugeJson);
+BENCHMARK(BM_AuricJson_ParseSaxHugeJsonUnvalidated);
+BENCHMARK(BM_AuricJson_ValidateThenParseSaxHugeJson);
+BENCHMARK(BM_AuricJson_StreamHugeJson)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK(BM_AuricJson_StructuralIndexHugeJson)
+    ->Arg(static_cast<int>(JsonSimdLevel::Scalar))
+    ->Arg(static_cast<int>(JsonSimdLevel::SSE2))
+    ->Arg(static_cast<int>(JsonSimdLevel::AVX2))
+    ->Arg(static_cast<int>(JsonSimdLevel::AVX512));
+BENCHMARK(BM_AuricJson_ParseSaxHugeJsonAtLevel)
+    ->Arg(static_cast<int>(JsonSimdLevel::Scalar))
+    ->Arg(static_cast<int>(JsonSimdLevel::SSE2))
+    ->Arg(static_cast<int>(JsonSimdLevel::AVX2))
+    ->Arg(static_cast<int>(JsonSimdLevel::AVX512));
+BENCHMARK(BM_AuricJson_ValidateUtf8HugeJson)
+    ->Arg(static_cast<int>(JsonSimdLevel::Scalar))
+    ->Arg(static_cast<int>(JsonSimdLevel::SSE2))
+    ->Arg(static_cast<int>(JsonSimdLevel::AVX2))
+    ->Arg(static_cast<int>(JsonSimdLevel::AVX512));
+BENCHMARK(BM_NlohmannJson_ParseHugeJson);
+BENCHMARK(BM_RapidJson_ParseHugeJson);
+BENCHMARK(BM_AuricJson_ParseNumbersJson);
+BENCHMARK(BM_AuricJson_ParseDocumentNumbersJson);
+BENCHMARK(BM_AuricJson_ParseSaxNumbersJson);
+BENCHMARK(BM_NlohmannJson_ParseNumbersJson);
+BENCHMARK(BM_RapidJson_ParseNumbersJson);
+BENCHMARK(BM_AuricJson_ParseCoordinatesJson);
+BENCHMARK(BM_AuricJson_ParseSaxCoordinatesJson);
+BENCHMARK(BM_NlohmannJson_ParseCoordinatesJson);
+BENCHMARK(BM_RapidJson_ParseCoordinatesJson);
+BENCHMARK(BM_AuricJson_WriteCoordinatesJson);
+BENCHMARK(BM_AuricJson_ParseEscapedJson);
+BENCHMARK(BM_AuricJson_ParseSaxEscapedJson);
+BENCHMARK(BM_NlohmannJson_ParseEscapedJson);
+BENCHMARK(BM_RapidJson_ParseEscapedJson);
+BENCHMARK(BM_AuricJson_ParseTextJson);
+BENCHMARK(BM_AuricJson_ParseSaxTextJson);
+BENCHMARK(BM_NlohmannJson_ParseTextJson);
+BENCHMARK(BM_AuricJson_ParseNestedJson);
+BENCHMARK(BM_AuricJson_ParseSaxNestedJson);
+BENCHMARK(BM_NlohmannJson_ParseNestedJson);
+BENCHMARK(BM_RapidJson_ParseNestedJson);
+
+BENCHMARK(BM_AuricJson_WriteMediumJson)->Arg(0)->Arg(1);
+BENCHMARK(BM_NlohmannJson_WriteMediumJson)->Arg(0)->Arg(1);
+BENCHMARK(BM_RapidJson_WriteMediumJson)->Arg(0)->Arg(1);
+BENCHMARK(BM_AuricJson_WriteLargeJson)->Arg(0)->Arg(1);
+BENCHMARK(BM_NlohmannJson_WriteLargeJson)->Arg(0)->Arg(1);
+BENCHMARK(BM_RapidJson_WriteLargeJson)->Arg(0)->Arg(1);
+BENCHMARK(BM_AuricJson_WriteHugeJson)->Arg(0)->Arg(1);
+BENCHMARK(BM_NlohmannJson_WriteHugeJson)->Arg(0)->Arg(1);
+BENCHMARK(BM_RapidJson_WriteHugeJson)->Arg(0)->Arg(1);
+
+BENCHMARK(BM_AuricJson_AccessLargeJsonCopying);
+BENCHMARK(BM_AuricJson_AccessLargeJsonByReference);
+
+BENCHMARK(BM_AuricJson_LookupWideObject)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_AuricJson_LookupWideObjectLinear)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_NlohmannJson_LookupWideObject)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_RapidJson_LookupWideObject)->Arg(16)->Arg(256)->Arg(4096);
+
+BENCHMARK(BM_AuricJson_ReadFileThenParseHugeJson);
+BENCHMARK(BM_AuricJson_ParseFileHugeJson);
+
+BENCHMARK(BM_AuricJson_SplitJsonLines);
+BENCHMARK(BM_AuricJson_ParseJsonLinesSequential);
+BENCHMARK(BM_AuricJson_ParseIntoJsonLinesSequential);
+BENCHMARK(BM_AuricJson_ParseJsonLines)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK(BM_AuricJson_ForEachJsonLines)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK(BM_NlohmannJson_ParseJsonLinesSequential);
+
+BENCHMARK(BM_AuricJson_RejectMalformedJson);
+BENCHMARK(BM_AuricJson_RejectMalformedJsonThrowing);
+BENCHMARK(BM_NlohmannJson_RejectMalformedJson);
+BENCHMARK(BM_RapidJson_RejectMalformedJson);
+
+BENCHMARK(BM_AuricJson_LazyAccessHugeJson);
+BENCHMARK(BM_AuricJson_ParseThenAccessHugeJson);
+BENCHMARK(BM_NlohmannJson_ParseThenAccessHugeJson);
+BENCHMARK(BM_AuricJson_LazyProjectHugeJson);
+BENCHMARK(BM_AuricJson_ParseThenProjectHugeJson);
+BENCHMARK(BM_AuricJson_LazyPathHugeJson);
+BENCHMARK(BM_AuricJson_ParseThenPathHugeJson);
+
+BENCHMARK(BM_AuricJson_ParseTapeHugeJson);
+BENCHMARK(BM_AuricJson_ParseDocumentMemoryHugeJson);
+BENCHMARK(BM_AuricJson_WalkTapeHugeJson);
+BENCHMARK(BM_AuricJson_WalkTreeHugeJson);
+BENCHMARK(BM_AuricJson_WalkDocumentHugeJson);
+BENCHMARK(BM_AuricJson_ParseTapeConfigJson);
+BENCHMARK(BM_AuricJson_ParseStaticConfigJson);
+
+BENCHMARK(BM_AuricJson_ParseAsHugeJson);
+BENCHMARK(BM_AuricJson_ParseThenCopyHugeJson);
+
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinary, SmallCbor, kSmallJson, JsonBinaryFormat::Cbor);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinary, SmallMessagePack, kSmallJson, JsonBinaryFormat::MessagePack);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinary, MediumCbor, kMediumJson, JsonBinaryFormat::Cbor);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinary, MediumMessagePack, kMediumJson, JsonBinaryFormat::MessagePack);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinary, LargeCbor, kLargeJson, JsonBinaryFormat::Cbor);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinary, LargeMessagePack, kLargeJson, JsonBinaryFormat::MessagePack);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinary, HugeCbor, kHugeJson, JsonBinaryFormat::Cbor);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinary, HugeMessagePack, kHugeJson, JsonBinaryFormat::MessagePack);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinaryDocument, LargeCbor, kLargeJson, JsonBinaryFormat::Cbor);
+BENCHMARK_CAPTURE(BM_AuricJson_ParseBinaryDocument, HugeCbor, kHugeJson, JsonBinaryFormat::Cbor);
+BENCHMARK_CAPTURE(BM_AuricJson_WriteBinary, LargeCbor, kLargeJson, JsonBinaryFormat::Cbor);
+BENCHMARK_CAPTURE(BM_AuricJson_WriteBinary, LargeMessagePack, kLargeJson, JsonBinaryFormat::MessagePack);
 
 BENCHMARK_MAIN();
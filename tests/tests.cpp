@@ -1,6 +1,9 @@
 // tests.cpp
 #include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
 #include <limits>
+#include <random>
 #include "../auric_json.h"
 
 using namespace std::string_view_literals;
@@ -259,6 +262,30 @@ TEST(JsonParser, ParseNumbersWithExponents) {
     }
 }
 
+TEST(JsonParser, ParseDoublesCorrectlyRounded) {
+    const auto bits = [](double d) { return std::bit_cast<uint64_t>(d); };
+    // Ties round to even, and digits past the nineteenth still decide them
+    for (auto [json, expected] : { std::pair { "9007199254740993.0"sv, 9007199254740992.0 }, { "9007199254740995.0"sv, 9007199254740996.0 },
+             { "9007199254740993.0000000000001"sv, 9007199254740994.0 }, { "0.30000000000000004"sv, 0.30000000000000004 }, { "1e23"sv, 1e23 },
+             { "-122.41941550000001"sv, -122.41941550000001 }, { "1.7976931348623157e308"sv, 1.7976931348623157e308 },
+             { "2.2250738585072014e-308"sv, 2.2250738585072014e-308 }, { "4.9e-324"sv, 5e-324 }, { "-0.0e5"sv, -0.0 }, { ".5"sv, 0.5 } }) {
+        EXPECT_EQ(bits(JsonParser::parse(json).toDouble()), bits(expected)) << json;
+    }
+
+    // Every double reads back from what the writer makes of it
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 100000; ++i) {
+        const double random = std::bit_cast<double>(rng());
+        const double decimal = double(rng() % 10000000000000) / std::pow(10.0, double(rng() % 24)); // in the fast paths' range
+        for (double d : { random, decimal, std::nextafter(decimal, 0.0) }) {
+            if (!std::isfinite(d))
+                continue;
+            const std::string json = JsonWriter::dump(JsonValue(d));
+            EXPECT_EQ(bits(JsonParser::parse(json).toDouble()), bits(d)) << json;
+        }
+    }
+}
+
 TEST(JsonParser, ParseNumbersWithLeadingZeros) {
     {
         std::string_view jsonStr = "0123"sv;
@@ -330,6 +357,49 @@ TEST(JsonParser, ParseNumberLimits) {
     }
 }
 
+TEST(JsonParser, ParseLargeIntegers) {
+    const JsonValue value = JsonParser::parse(
+        "[2147483648, -2147483649, 1700000000123456789, -9223372036854775808, 9223372036854775808, "
+        "18446744073709551615, 18446744073709551616, -9223372036854775809, 00000000000000000000012]");
+    const auto& arr = std::get<JsonValue::Array>(value.value);
+    EXPECT_EQ(std::get<int64_t>(arr[0].value), 2147483648);
+    EXPECT_EQ(std::get<int64_t>(arr[1].value), -2147483649);
+    EXPECT_EQ(arr[2].toInt64(), 1700000000123456789);
+    EXPECT_EQ(arr[3].toInt64(), std::numeric_limits<int64_t>::min());
+    EXPECT_EQ(std::get<uint64_t>(arr[4].value), 9223372036854775808u);
+    EXPECT_EQ(arr[5].toUInt64(), std::numeric_limits<uint64_t>::max());
+    EXPECT_THROW(arr[5].toInt64(), std::runtime_error);
+    EXPECT_EQ(arr[6].toDouble(), 18446744073709551616.0);
+    EXPECT_EQ(arr[7].toDouble(), -9223372036854775809.0);
+    EXPECT_EQ(arr[8].toInt(), 12);
+    // Small values keep using int, and widen through the 64-bit accessors
+    EXPECT_EQ(JsonParser::parse("-7").toInt64(), -7);
+    EXPECT_THROW(JsonParser::parse("-7").toUInt64(), std::runtime_error);
+
+    const JsonValue raw = JsonParser::parse("[123456789012345678901234567890, -18446744073709551616, 5]", { .rawBigIntegers = true });
+    const auto& rawArr = std::get<JsonValue::Array>(raw.value);
+    EXPECT_EQ(std::get<JsonValue::RawNumber>(rawArr[0].value).text, "123456789012345678901234567890");
+    EXPECT_EQ(std::get<JsonValue::RawNumber>(rawArr[1].value).text, "-18446744073709551616");
+    EXPECT_TRUE(rawArr[2].isInt());
+    EXPECT_EQ(JsonWriter::dump(raw), "[123456789012345678901234567890,-18446744073709551616,5]");
+    EXPECT_EQ(JsonWriter::dump(value).substr(0, 54), "[2147483648,-2147483649,1700000000123456789,-922337203");
+
+    JsonDocument doc = JsonParser::parseDocument("[99999999999999999999, 4294967296]", { .rawBigIntegers = true });
+    const auto& docArr = std::get<JsonDocument::Value::Array>(doc.root().value);
+    EXPECT_EQ(std::get<JsonDocument::Value::RawNumber>(docArr[0].value).text, "99999999999999999999");
+    EXPECT_EQ(docArr[1].toInt64(), 4294967296);
+
+    // SAX and streaming report the same widths
+    JsonDomHandler handler;
+    JsonStreamParser stream(handler);
+    stream.feed("[4294967296, 18446744073709551615, 1]");
+    stream.finish();
+    EXPECT_EQ(handler.value(), JsonParser::parse("[4294967296, 18446744073709551615, 1]"));
+    JsonDomHandler rawHandler;
+    JsonParser::parseSax("[1e2, 99999999999999999999]", rawHandler, { .rawBigIntegers = true });
+    EXPECT_EQ(rawHandler.value(), JsonParser::parse("[1e2, 99999999999999999999]", { .rawBigIntegers = true }));
+}
+
 TEST(JsonParser, ParseComplexStructure) {
     std::string_view jsonStr = R"(
        {
@@ -533,6 +603,1114 @@ TEST(JsonParser, ParseComplexJsonStructure) {
     EXPECT_EQ(obj["escaped"], "Tab:\t Newline:\n Quote:\" Backslash:\\ Unicode:✨");
 }
 
+TEST(JsonParser, ParseIndexedMatchesParse) {
+    std::string_view jsonStr = R"(
+       {
+           "name": "John Doe",
+           "age": 30,
+           "height": 1.75,
+           "married": false,
+           "hobbies": null,
+           "tags": ["a,b", "[c]", "{d}", "e:f", "", "trailing",],
+           "escape": "Tab:\t Quote:\" Backslash:\\ Slash:\/ Unicode:✨",
+           "backslashes": "\\\\\\\"",
+           "description": "Hello, world! 😊 これは日本語のテキストです。 🇯🇵",
+           "nested": {"arr": [1, [2, [3, [4, [5]]]]], "obj": {"a": {"b": {}}}, "empty": []},
+           "scores": [7.5, -3.14, 1.23e+4, -5.67E-8, 0]
+       }
+   )"sv;
+
+    JsonParser parser;
+    EXPECT_EQ(parser.parseIndexed(jsonStr), parser.parse(jsonStr));
+    EXPECT_EQ(parser.parseIndexed("42"sv), parser.parse("42"sv));
+    EXPECT_EQ(parser.parseIndexed(R"("\"")"sv), parser.parse(R"("\"")"sv));
+}
+
+TEST(JsonParser, ParseIndexedRejectsInvalidJson) {
+    JsonParser parser;
+    EXPECT_THROW(parser.parseIndexed(""sv), std::runtime_error);
+    EXPECT_THROW(parser.parseIndexed("[1 2]"sv), std::runtime_error);
+    EXPECT_THROW(parser.parseIndexed("[truex]"sv), std::runtime_error);
+    EXPECT_THROW(parser.parseIndexed(R"({"a" 1})"sv), std::runtime_error);
+    EXPECT_THROW(parser.parseIndexed(R"(["abc)"sv), std::runtime_error);
+    EXPECT_THROW(parser.parseIndexed("[1, 2"sv), std::runtime_error);
+
+    // Errors and options behave as in tryParse
+    const JsonParseOptions options[] = { {}, { .rawBigIntegers = true, .validateUtf8 = false, .replaceLoneSurrogates = true }, { .maxDepth = 2 } };
+    for (const auto& opts : options) {
+        for (const std::string_view json : { "[1 2]"sv, "[[[1]]]"sv, "[[1]]"sv, "[123456789012345678901234567890]"sv, "\"\\ud800\""sv, "[\"\xff\"]"sv, "{\"a\": [tru]}"sv }) {
+            const auto indexed = JsonParser::tryParseIndexed(json, opts);
+            const auto parsed = JsonParser::tryParse(json, opts);
+            ASSERT_EQ(indexed.hasValue(), parsed.hasValue()) << json;
+            if (parsed)
+                EXPECT_EQ(indexed.value(), parsed.value()) << json;
+            else
+                EXPECT_EQ(std::pair(indexed.error().code, indexed.error().offset), std::pair(parsed.error().code, parsed.error().offset)) << json;
+        }
+    }
+}
+
+TEST(JsonStructuralIndex, AllSimdLevelsAgree) {
+    // Escapes and quotes straddling the 64-byte block boundaries
+    std::string json = "[";
+    for (int i = 0; i < 200; ++i) {
+        json += "\"" + std::string(i % 67, 'x') + std::string(i % 5, '\\') + (i % 5 % 2 ? "\"" : "") + "\", ";
+        json += std::to_string(i) + ", {\"k\": [true, null]},\n";
+    }
+    json += "false]";
+
+    const auto reference = JsonStructuralIndex::build(json, JsonSimdLevel::Scalar);
+    for (auto level : { JsonSimdLevel::SSE2, JsonSimdLevel::SSE42, JsonSimdLevel::AVX2, JsonSimdLevel::AVX512 }) {
+        if (!JsonSimd::isSupported(level))
+            continue;
+        EXPECT_EQ(JsonStructuralIndex::build(json, level).positions, reference.positions);
+    }
+    EXPECT_EQ(JsonParser::parseIndexed(json, reference), JsonParser::parse(json));
+}
+
+TEST(JsonSimd, AllKernelLevelsMatchScalar) {
+    // Every match position within and past each register width, from unaligned starts
+    const std::string bytes = " \t\n\r\v\f\"\\09/:\x1f\x20\x7f\x80\xff\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\xed\xa0\x80\xc0\xaf\xf4\x90";
+    std::vector<std::string> inputs;
+    for (char fill : { ' ', 'a', '7' }) {
+        for (size_t length = 0; length <= 150; ++length) {
+            for (char c : bytes) {
+                inputs.push_back(std::string(length, fill) + c + std::string(length % 19, fill));
+            }
+        }
+    }
+    const std::string text = "  {\"k\": \"caf\xc3\xa9 \xe2\x82\xac\xf0\x9f\x98\x80\\n\", \"n\": 1234567890.5},\n";
+    std::string repeated;
+    for (int i = 0; i < 40; ++i)
+        repeated += text;
+    for (size_t cut = 0; cut < repeated.size(); cut += 7)
+        inputs.push_back(repeated.substr(cut));
+
+    using Kernel = const char* (*)(const char*, const char*, JsonSimdLevel);
+    const Kernel kernels[] = { JsonSimd::skipWhitespace, JsonSimd::findQuoteOrBackslash, JsonSimd::findEscape, JsonSimd::findNonDigit, JsonSimd::validateUtf8 };
+    for (auto level : { JsonSimdLevel::SSE2, JsonSimdLevel::SSE42, JsonSimdLevel::AVX2, JsonSimdLevel::AVX512 }) {
+        if (!JsonSimd::isSupported(level))
+            continue;
+        for (const auto& input : inputs) {
+            for (size_t start = 0; start < std::min<size_t>(input.size(), 3); ++start) {
+                const char* begin = input.data() + start;
+                const char* end = input.data() + input.size();
+                for (size_t k = 0; k < std::size(kernels); ++k) {
+                    ASSERT_EQ(kernels[k](begin, end, level) - begin, kernels[k](begin, end, JsonSimdLevel::Scalar) - begin)
+                        << JsonSimd::levelName(level) << " kernel " << k << " on " << JsonWriter::dump(JsonValue(input));
+                }
+            }
+        }
+        std::string block = repeated.substr(0, JsonSimd::kBlockSize);
+        const auto masks = JsonSimd::classifyBlock(block.data(), level);
+        const auto reference = JsonSimd::classifyBlock(block.data(), JsonSimdLevel::Scalar);
+        EXPECT_EQ(masks.quote, reference.quote);
+        EXPECT_EQ(masks.backslash, reference.backslash);
+        EXPECT_EQ(masks.structural, reference.structural);
+        EXPECT_EQ(masks.whitespace, reference.whitespace);
+        EXPECT_EQ(masks.newline, reference.newline);
+    }
+}
+
+TEST(JsonSimd, StringRunsMatchScalar) {
+    // Runs of every length around the copied prefix and the register widths,
+    // between escapes, decoded at every level
+    const std::pair<std::string_view, std::string_view> escapes[] = { { "\\n", "\n" }, { "\\\"", "\"" }, { "\\\\", "\\" },
+        { "\\u00e9", "\xc3\xa9" }, { "\\ud83d\\ude00", "\xf0\x9f\x98\x80" } };
+    const auto run = [](size_t length) {
+        std::string text;
+        for (size_t i = 0; i < length; ++i)
+            text += i % 29 == 28 ? "\xe2\x82\xac" : std::string(1, static_cast<char>('a' + i % 26));
+        return text;
+    };
+    std::string array = "[";
+    JsonValue::Array expected;
+    for (size_t length = 0; length <= 140; ++length) {
+        for (const auto& [escaped, decoded] : escapes) {
+            array += "\"" + run(length) + std::string(escaped) + run(length % 13) + std::string(escaped) + run(70 - length % 70) + "\",";
+            expected.elements.emplace_back(run(length) + std::string(decoded) + run(length % 13) + std::string(decoded) + run(70 - length % 70));
+        }
+    }
+    array.back() = ']';
+
+    const JsonSimdLevel initial = JsonSimd::activeLevel();
+    for (auto level : { JsonSimdLevel::Scalar, JsonSimdLevel::SSE2, JsonSimdLevel::SSE42, JsonSimdLevel::AVX2, JsonSimdLevel::AVX512 }) {
+        if (!JsonSimd::isSupported(level))
+            continue;
+        JsonSimd::setLevel(level);
+        EXPECT_EQ(JsonParser::parse(array), JsonValue(expected)) << JsonSimd::levelName(level);
+        EXPECT_EQ(JsonParser::parseTape(array).root().materialize(), JsonValue(expected)) << JsonSimd::levelName(level);
+        const JsonDocument doc = JsonParser::parseDocument(array);
+        const auto& elements = JsonDocument::Value::toArray(doc.root()).elements;
+        ASSERT_EQ(elements.size(), expected.elements.size());
+        for (size_t i = 0; i < elements.size(); ++i)
+            ASSERT_EQ(elements[i].toString(), expected.elements[i].toString()) << JsonSimd::levelName(level) << " string " << i;
+
+        JsonDomHandler handler;
+        JsonStreamParser stream(handler);
+        for (size_t pos = 0; pos < array.size(); pos += 61)
+            stream.feed(std::string_view(array).substr(pos, 61));
+        stream.finish();
+        EXPECT_EQ(handler.value(), JsonValue(expected)) << JsonSimd::levelName(level);
+    }
+    JsonSimd::setLevel(initial);
+}
+
+TEST(JsonSimd, ValidatesUtf8) {
+    auto firstInvalid = [](std::string_view str) { return JsonSimd::validateUtf8(str.data(), str.data() + str.size()) - str.data(); };
+    EXPECT_EQ(firstInvalid("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf"), 19);
+    EXPECT_EQ(firstInvalid("ab\x80"), 2); // stray continuation byte
+    EXPECT_EQ(firstInvalid("ab\xc0\xaf"), 2); // overlong
+    EXPECT_EQ(firstInvalid("ab\xe0\x9f\xbf"), 2); // overlong
+    EXPECT_EQ(firstInvalid("ab\xed\xa0\x80"), 2); // surrogate
+    EXPECT_EQ(firstInvalid("ab\xf4\x90\x80\x80"), 2); // beyond U+10FFFF
+    EXPECT_EQ(firstInvalid("ab\xe2\x82"), 2); // truncated
+    EXPECT_EQ(firstInvalid("ab\xe2\x82x"), 2);
+    EXPECT_EQ(firstInvalid("ab\xff"), 2);
+}
+
+TEST(JsonSimd, SetLevelClampsToSupportedLevels) {
+    const JsonSimdLevel initial = JsonSimd::activeLevel();
+    EXPECT_EQ(JsonSimd::setLevel(JsonSimdLevel::Scalar), JsonSimdLevel::Scalar);
+    EXPECT_EQ(JsonSimd::activeLevel(), JsonSimdLevel::Scalar);
+    EXPECT_EQ(JsonParser::parse(R"( [ "a\"b",   {"c": 1} ] )"sv), JsonParser::parse(R"(["a\"b",{"c":1}])"sv));
+    EXPECT_EQ(JsonSimd::setLevel(JsonSimdLevel::AVX512), JsonSimd::detectedLevel());
+    EXPECT_EQ(JsonSimd::setLevel(initial), initial);
+
+    EXPECT_EQ(JsonSimd::parseLevel("avx2"), JsonSimdLevel::AVX2);
+    EXPECT_EQ(JsonSimd::parseLevel(JsonSimd::levelName(JsonSimdLevel::SSE42)), JsonSimdLevel::SSE42);
+    EXPECT_EQ(JsonSimd::parseLevel("mmx"), std::nullopt);
+}
+
+TEST(JsonStructuralIndex, TokenPositions) {
+    std::string_view jsonStr = R"( {"a\"b": [12, true]} )"sv;
+    const auto index = JsonStructuralIndex::build(jsonStr);
+    const std::vector<uint32_t> expected = { 1, 2, 8, 10, 11, 13, 15, 19, 20, 22 };
+    EXPECT_EQ(index.positions, expected);
+}
+
+TEST(JsonDocument, ParseDocument) {
+    std::string_view jsonStr = R"(
+        {
+            "name": "John",
+            "age": 30,
+            "score": 7.5,
+            "escape": "Quote:\" Unicode:✨",
+            "hobbies": ["reading", "traveling", {"nested": [null, true]}]
+        }
+    )"sv;
+
+    JsonDocument doc = JsonParser::parseDocument(jsonStr);
+    const auto& obj = JsonDocument::Value::toObject(doc.root());
+    EXPECT_EQ(obj.members.size(), 5U);
+    EXPECT_EQ(obj["name"].toString(), "John"sv);
+    EXPECT_EQ(obj["age"].toInt(), 30);
+    EXPECT_NEAR(obj["score"].toDouble(), 7.5, 0.001);
+    EXPECT_EQ(obj["escape"].toString(), "Quote:\" Unicode:✨"sv);
+
+    const auto& hobbies = std::get<JsonDocument::Value::Array>(obj["hobbies"].value);
+    EXPECT_EQ(hobbies.elements.size(), 3U);
+    EXPECT_EQ(hobbies[1], "traveling");
+    const auto& nested = std::get<JsonDocument::Value::Object>(hobbies[2].value);
+    EXPECT_EQ(nested["nested"], JsonDocument::Value::Array({ { nullptr, true }, doc.allocator() }));
+
+    // Moving hands the tree over; the moved-from document can be reassigned
+    const JsonDocument::Value* root = &doc.root();
+    JsonDocument moved = std::move(doc);
+    EXPECT_EQ(&moved.root(), root);
+    doc = JsonParser::parseDocument("[1]");
+    moved = std::move(doc);
+    EXPECT_EQ(moved.root(), JsonParser::parseDocument("[1]").root());
+    doc = std::move(moved);
+    EXPECT_EQ(JsonDocument::Value::toArray(doc.root())[0].toInt(), 1);
+}
+
+TEST(JsonDocument, AllocatesFromArena) {
+    // Counts the blocks the arena requests from its upstream resource
+    struct CountingResource : std::pmr::memory_resource {
+        size_t allocations = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    std::string json = "[";
+    for (int i = 0; i < 1000; ++i)
+        json += R"({"key": "a string long enough to defeat the small string optimization", "n": [1, 2.5]},)";
+    json.back() = ']';
+
+    CountingResource upstream;
+    {
+        JsonDocument doc(1 << 20, &upstream);
+        JsonParser::parseDocument(json, doc);
+        const auto& arr = JsonDocument::Value::toArray(doc.root());
+        EXPECT_EQ(arr.elements.size(), 1000U);
+        EXPECT_EQ(JsonDocument::Value::toObject(arr[999])["key"], "a string long enough to defeat the small string optimization");
+    }
+    EXPECT_LT(upstream.allocations, 10U);
+}
+
+TEST(JsonDocument, BorrowStrings) {
+    const std::string json = R"({"plain": "no escapes here", "escaped": "tab:\t quote:\" ✨", "list": ["a", "b\/c"]})";
+    const auto inInput = [&](std::string_view str) {
+        return str.data() >= json.data() && str.data() + str.size() <= json.data() + json.size();
+    };
+
+    JsonDocument doc = JsonParser::parseDocument(json, { .borrowStrings = true });
+    const auto& obj = std::get<JsonDocument::Value::Object>(doc.root().value);
+    EXPECT_TRUE(inInput(obj.members[0].first));
+    EXPECT_TRUE(inInput(obj["plain"].toString()));
+    EXPECT_EQ(obj["plain"].toString(), "no escapes here"sv);
+
+    EXPECT_FALSE(inInput(obj["escaped"].toString()));
+    EXPECT_EQ(obj["escaped"].toString(), "tab:\t quote:\" ✨"sv);
+
+    const auto& list = std::get<JsonDocument::Value::Array>(obj["list"].value);
+    EXPECT_TRUE(inInput(list[0].toString()));
+    EXPECT_FALSE(inInput(list[1].toString()));
+    EXPECT_EQ(list[1].toString(), "b/c"sv);
+
+    // Without the option every string is copied into the arena
+    JsonDocument copied = JsonParser::parseDocument(json);
+    const auto& copiedObj = std::get<JsonDocument::Value::Object>(copied.root().value);
+    EXPECT_FALSE(inInput(copiedObj["plain"].toString()));
+    EXPECT_EQ(copiedObj["plain"], obj["plain"]);
+}
+
+TEST(JsonParser, WideObjectLookup) {
+    std::string json = "{";
+    for (int i = 0; i < 100; ++i) {
+        json += (i ? ",\"key" : "\"key") + std::to_string(i) + "\": " + std::to_string(i);
+    }
+    json += ", \"key7\": -1}";
+
+    // Lookups never build the index themselves
+    const JsonValue unindexed = JsonParser::parse(json);
+    const auto& unindexedObj = std::get<JsonValue::Object>(unindexed.value);
+    EXPECT_EQ(unindexedObj["key42"].toInt(), 42);
+    EXPECT_FALSE(unindexedObj.contains("missing"));
+    EXPECT_TRUE(unindexedObj.keyIndex.slots.empty());
+
+    JsonValue value = JsonParser::parse(json, { .indexObjects = true });
+    auto& obj = std::get<JsonValue::Object>(value.value);
+    EXPECT_FALSE(obj.keyIndex.slots.empty());
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(obj["key" + std::to_string(i)].toInt(), i);
+    }
+    EXPECT_EQ(obj.find("missing"), nullptr);
+    EXPECT_THROW(obj["missing"], std::runtime_error);
+    EXPECT_EQ(value, unindexed);
+    // Members keep insertion order, and the first of duplicate keys wins
+    EXPECT_EQ(obj.members[0].first, "key0");
+    EXPECT_EQ(obj.members.back().second.toInt(), -1);
+
+    // Editing members directly never makes lookups wrong, even when the size
+    // stays the same
+    obj.members.erase(obj.members.begin());
+    obj.members.emplace_back("new", true);
+    EXPECT_TRUE(obj.contains("new"));
+    EXPECT_EQ(obj["key99"].toInt(), 99);
+    EXPECT_FALSE(obj.contains("key0"));
+    obj.members[3].first = "renamed";
+    EXPECT_EQ(obj["renamed"].toInt(), 4);
+    EXPECT_FALSE(obj.contains("key4"));
+    obj.members.emplace_back("added", 1);
+    EXPECT_EQ(obj["added"].toInt(), 1);
+    obj.buildIndex();
+    EXPECT_EQ(obj.keyIndex.indexedSize, obj.members.size());
+    EXPECT_EQ(obj["renamed"].toInt(), 4);
+
+    JsonDocument doc = JsonParser::parseDocument(json, { .indexObjects = true });
+    const auto& docObj = std::get<JsonDocument::Value::Object>(doc.root().value);
+    EXPECT_EQ(docObj["key42"].toInt(), 42);
+    EXPECT_EQ(docObj.keyIndex.slots.get_allocator().resource(), doc.allocator().resource());
+}
+
+template <typename T>
+concept ViewsTemporaryString = requires { std::declval<T>().asStringView(); };
+
+TEST(JsonValue, ReferenceAccessors) {
+    JsonValue json = JsonParser::parse(R"({"list": [1, "a string too long for small string storage"], "n": 2})");
+    const JsonValue& constJson = json;
+    EXPECT_EQ(&constJson.asObject()["list"].asArray()[1], &std::get<JsonValue::Object>(json.value).members[0].second.asArray()[1]);
+    EXPECT_EQ(constJson.asObject()["list"].asArray()[1].asStringView(), "a string too long for small string storage"sv);
+    EXPECT_THROW(constJson.asObject()["n"].asString(), std::runtime_error);
+    EXPECT_THROW(constJson.asArray(), std::runtime_error);
+
+    json.asObject()["list"].asArray()[1].asString() += "!";
+    EXPECT_EQ(json.asObject()["list"].asArray()[1].asStringView(), "a string too long for small string storage!"sv);
+
+    // Temporaries hand over their payload rather than copying it
+    JsonValue& str = json.asObject()["list"].asArray()[1];
+    const char* const chars = str.asString().data();
+    EXPECT_EQ(std::move(str).toString().data(), chars);
+    JsonValue::Array list = std::move(json.asObject()["list"]).asArray();
+    EXPECT_EQ(list.elements.size(), 2u);
+    EXPECT_EQ(JsonParser::parse(R"(["x"])").asArray()[0].toString(), "x");
+    static_assert(!ViewsTemporaryString<JsonValue>);
+    static_assert(ViewsTemporaryString<JsonValue&>);
+}
+
+TEST(JsonParser, ParseIntoReusesStorage) {
+    JsonValue json;
+    JsonParser::parseInto(R"({"name": "a string too long for small string storage", "tags": ["first", 1, 2]})", json);
+    const auto* members = std::get<JsonValue::Object>(json.value).members.data();
+    const char* name = json.asObject()["name"].asString().data();
+    const JsonValue* tags = json.asObject()["tags"].asArray().elements.data();
+
+    // A document of the same shape is parsed into the same memory
+    JsonParser::parseInto(R"({"name": "another string too long for small storage", "tags": ["second\n", 3, 4]})", json);
+    EXPECT_EQ(json, JsonParser::parse(R"({"name": "another string too long for small storage", "tags": ["second\n", 3, 4]})"));
+    EXPECT_EQ(std::get<JsonValue::Object>(json.value).members.data(), members);
+    EXPECT_EQ(json.asObject()["name"].asString().data(), name);
+    EXPECT_EQ(json.asObject()["tags"].asArray().elements.data(), tags);
+
+    // Other shapes replace what does not fit
+    const std::string_view other = R"({"tags": {"k": null}, "name": [true, "x"], "extra": 1.5})";
+    JsonParser::parseInto(other, json);
+    EXPECT_EQ(json, JsonParser::parse(other));
+    EXPECT_EQ(json.asObject()["extra"].toDouble(), 1.5);
+    JsonParser::parseInto("[]", json);
+    EXPECT_EQ(json, JsonParser::parse("[]"));
+
+    EXPECT_EQ(JsonParser::tryParseInto(R"([1, "two", [3)", json).code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_THROW(JsonParser::parseInto("[1 2]", json), std::runtime_error);
+    JsonParser::parseInto(other, json);
+    EXPECT_EQ(json, JsonParser::parse(other));
+}
+
+TEST(JsonParser, TryParseReportsErrors) {
+    const auto error = [](std::string_view json) {
+        return JsonParser::tryParse(json).error();
+    };
+    EXPECT_EQ(error("").code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_EQ(error("[1, 2").code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_EQ(error("[1 2]").code, JsonErrorCode::ExpectedCommaOrBracket);
+    EXPECT_EQ(error(R"({"a": 1 "b": 2})").code, JsonErrorCode::ExpectedCommaOrBrace);
+    EXPECT_EQ(error("{1: 2}").code, JsonErrorCode::ExpectedKey);
+    EXPECT_EQ(error(R"({"a" 1})").code, JsonErrorCode::ExpectedColon);
+    EXPECT_EQ(error("[nul]").code, JsonErrorCode::ExpectedNull);
+    EXPECT_EQ(error("[tru]").code, JsonErrorCode::ExpectedTrue);
+    EXPECT_EQ(error("[fals]").code, JsonErrorCode::ExpectedFalse);
+    EXPECT_EQ(error(R"(["\x"])").code, JsonErrorCode::InvalidEscape);
+    EXPECT_EQ(error(R"(["abc)").code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_EQ(error("[-]").code, JsonErrorCode::InvalidNumber);
+    EXPECT_EQ(error("[1]").code, JsonErrorCode::None);
+    EXPECT_EQ(error(" [1] \n").code, JsonErrorCode::None);
+
+    // Anything but whitespace after the root value is rejected by every text
+    // entry point, at its first byte
+    for (const auto& [json, offset] : { std::pair { "[1]]"sv, 3u }, { "1 2"sv, 2u }, { "[1] x"sv, 4u }, { "{} {}"sv, 3u }, { "\"a\"\"b\""sv, 3u } }) {
+        const auto expectTrailing = [&](const JsonError& e) {
+            EXPECT_EQ(e.code, JsonErrorCode::TrailingData) << json;
+            EXPECT_EQ(e.offset, offset) << json;
+        };
+        expectTrailing(error(json));
+        expectTrailing(JsonParser::tryParseIndexed(json).error());
+        expectTrailing(JsonParser::tryParseDocument(json).error());
+        expectTrailing(JsonParser::tryParseTape(json).error());
+        expectTrailing(JsonParser::tryParseAs<JsonValue>(json).error());
+        JsonValue target;
+        expectTrailing(JsonParser::tryParseInto(json, target));
+        JsonSaxHandler handler;
+        expectTrailing(JsonParser::tryParseSax(json, handler));
+    }
+    EXPECT_EQ(JsonParser::tryParseAs<std::vector<int>>("[1] 2").error().code, JsonErrorCode::TrailingData);
+
+    const JsonError located = error("{\n  \"a\": [1,\n        x]\n}");
+    EXPECT_EQ(located.code, JsonErrorCode::InvalidNumber);
+    EXPECT_EQ(located.offset, 21u);
+    EXPECT_EQ(located.line, 3u);
+    EXPECT_EQ(located.column, 9u);
+    EXPECT_STREQ(located.message(), "Invalid number format");
+
+    // The throwing API raises the same error
+    try {
+        JsonParser::parse("[1 2]");
+        FAIL();
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), "Invalid JSON: expected ',' or ']'");
+    }
+}
+
+TEST(JsonParser, RejectsInvalidUtf8) {
+    const std::string_view invalid = "{\"caf\xc3\xa9\": [\"ok\", \"\xe2\x82\xac \xe2\x82\"]}";
+    const JsonError error = JsonParser::tryParse(invalid).error();
+    EXPECT_EQ(error.code, JsonErrorCode::InvalidUtf8);
+    EXPECT_EQ(error.offset, invalid.find("\xe2\x82\""));
+    EXPECT_EQ(JsonParser::tryParse("{\"\xed\xa0\x80\": 1}").error().offset, 2u); // surrogate in a key
+    EXPECT_EQ(JsonParser::tryParse("[\"\\n\xc0\xaf\"]").error().offset, 4u); // after an escape
+
+    JsonDocument doc;
+    EXPECT_EQ(JsonParser::tryParseDocument(invalid, doc).code, JsonErrorCode::InvalidUtf8);
+    JsonSaxHandler handler;
+    EXPECT_EQ(JsonParser::tryParseSax(invalid, handler).code, JsonErrorCode::InvalidUtf8);
+    EXPECT_EQ(JsonParser::tryParseTape(invalid).error().code, JsonErrorCode::InvalidUtf8);
+    using Typed = std::map<std::string, std::vector<std::string>>;
+    EXPECT_EQ(JsonParser::tryParseAs<Typed>(invalid).error().code, JsonErrorCode::InvalidUtf8);
+    EXPECT_EQ(JsonParser::tryParseBinary("\x62\xc3\x28"sv, JsonBinaryFormat::Cbor).error().offset, 1u);
+
+    // Unchecked, the bytes pass through as they are
+    const JsonValue value = JsonParser::parse(invalid, { .validateUtf8 = false });
+    EXPECT_EQ(value.toObject()["caf\xc3\xa9"].toArray()[1].toString(), "\xe2\x82\xac \xe2\x82");
+}
+
+TEST(JsonParser, DecodesSurrogatePairs) {
+    const std::string_view pairs = R"("\ud83d\ude00 \ud83d\ude03 \u00e9\u4e16")"sv;
+    EXPECT_EQ(JsonParser::parse(pairs).toString(), "😀 😃 é世");
+    EXPECT_EQ(JsonParser::parseDocument(pairs).root().toString(), "😀 😃 é世"sv);
+    EXPECT_EQ(JsonParser::parseTape(pairs).root().toString(), "😀 😃 é世");
+
+    // Unpaired surrogates fail at their backslash, or decode to U+FFFD
+    for (auto [json, offset] : { std::pair { R"(["\ud83d"])"sv, 2u }, { R"(["a\ude00\ud83d\ude00"])"sv, 3u }, { R"(["\ud83dA"])"sv, 2u },
+             { R"(["\ud83d\ud83e"])"sv, 2u } }) {
+        const JsonError error = JsonParser::tryParse(json).error();
+        EXPECT_EQ(error.code, JsonErrorCode::InvalidCodepoint) << json;
+        EXPECT_EQ(error.offset, offset) << json;
+    }
+    const JsonParseOptions replace { .replaceLoneSurrogates = true };
+    EXPECT_EQ(JsonParser::parse(R"("\ud83dx\ude00\ud83d\n\ud83d\ud83d\ude00\ud83d")", replace).toString(), "�x��\n�😀�");
+
+    // Only hex digits are accepted
+    for (auto json : { R"("\u12g4")"sv, R"("\u-123")"sv, R"("\u 123")"sv })
+        EXPECT_EQ(JsonParser::tryParse(json).error().code, JsonErrorCode::InvalidEscape) << json;
+    EXPECT_EQ(JsonParser::tryParse(R"("\u12g4")").error().offset, 5u);
+    EXPECT_EQ(JsonParser::tryParse(R"("\u12)").error().code, JsonErrorCode::UnexpectedEnd);
+}
+
+TEST(JsonParser, TryParseValues) {
+    auto result = JsonParser::tryParse(R"({"name": "auric", "tags": [1, 2.5]})");
+    ASSERT_TRUE(result);
+    EXPECT_FALSE(result.error());
+    const auto* obj = result->tryGet<JsonValue::Object>();
+    ASSERT_NE(obj, nullptr);
+    EXPECT_EQ(obj->find("name")->tryGet<int>(), nullptr);
+    EXPECT_EQ(*obj->find("name")->tryGet<std::string>(), "auric");
+    const auto* tags = (*obj)["tags"].tryGet<JsonValue::Array>();
+    ASSERT_NE(tags, nullptr);
+    EXPECT_EQ(*(*tags)[1].tryGet<double>(), 2.5);
+    EXPECT_EQ(result.value(), JsonParser::parse(R"({"name": "auric", "tags": [1, 2.5]})"));
+
+    auto failed = JsonParser::tryParse("[1,");
+    EXPECT_FALSE(failed);
+    EXPECT_THROW(failed.value(), std::runtime_error);
+
+    JsonDocument doc;
+    JsonParser::parseDocument("[1, 2]", doc);
+    EXPECT_EQ(JsonParser::tryParseDocument("[3, ", doc).code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_EQ(std::get<JsonDocument::Value::Array>(doc.root().value).elements.size(), 2u);
+    EXPECT_EQ(JsonParser::tryParseDocument("{}").error().code, JsonErrorCode::None);
+}
+
+TEST(JsonDocument, ParseFile) {
+    const std::string path = (std::filesystem::temp_directory_path() / "auric_json_parse_file.json").string();
+    const std::string json = R"({"name": "mapped", "escaped": "a\nb", "values": [1, 2.5, null]})";
+    std::ofstream(path, std::ios::binary) << json;
+
+    JsonDocument doc = JsonParser::parseFile(path);
+    const std::string_view mapped = doc.attached().data();
+    EXPECT_EQ(mapped, json);
+    const auto& obj = std::get<JsonDocument::Value::Object>(doc.root().value);
+    const std::string_view name = obj["name"].toString();
+    EXPECT_EQ(name, "mapped");
+    EXPECT_TRUE(name.data() >= mapped.data() && name.data() < mapped.data() + mapped.size());
+    EXPECT_EQ(obj["escaped"].toString(), "a\nb");
+    EXPECT_EQ(JsonWriter::dump(doc.root()), JsonWriter::dump(JsonParser::parse(json)));
+
+    // Documents own their mapping and can outlive the call
+    JsonDocument moved = std::move(doc);
+    EXPECT_EQ(std::get<JsonDocument::Value::Object>(moved.root().value)["name"].toString(), "mapped");
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "[1, 2";
+    EXPECT_EQ(JsonParser::tryParseFile(path).error().code, JsonErrorCode::UnexpectedEnd);
+    std::ofstream(path, std::ios::binary | std::ios::trunc);
+    EXPECT_EQ(JsonParser::tryParseFile(path).error().code, JsonErrorCode::UnexpectedEnd);
+    std::filesystem::remove(path);
+    EXPECT_EQ(JsonParser::tryParseFile(path).error().code, JsonErrorCode::FileError);
+    EXPECT_THROW(JsonParser::parseFile(path), std::runtime_error);
+}
+
+TEST(JsonParser, ParseSaxEvents) {
+    struct Recorder : JsonSaxHandler {
+        std::string events;
+
+        void onNull() { events += "null "; }
+        void onBool(bool b) { events += b ? "true " : "false "; }
+        void onInt(int n) { events += "int:" + std::to_string(n) + " "; }
+        void onDouble(double) { events += "double "; }
+        void onString(std::string_view str) { events += "str:" + std::string(str) + " "; }
+        void onKey(std::string_view key) { events += "key:" + std::string(key) + " "; }
+        void onStartObject() { events += "{ "; }
+        void onEndObject() { events += "} "; }
+        void onStartArray() { events += "[ "; }
+        void onEndArray() { events += "] "; }
+    };
+
+    Recorder recorder;
+    JsonParser::parseSax(R"({"a": [1, 2.5, "x\ty", null], "b\"": {"c": true, "d": false,}, "e": []})"sv, recorder);
+    EXPECT_EQ(recorder.events, "{ key:a [ int:1 double str:x\ty null ] key:b\" { key:c true key:d false } key:e [ ] } ");
+
+    EXPECT_THROW(JsonParser::parseSax("[1, 2"sv, recorder), std::runtime_error);
+}
+
+TEST(JsonParser, ParseSaxExtractsFields) {
+    // Only overrides the events it needs
+    struct FieldExtractor : JsonSaxHandler {
+        int depth = 0;
+        bool nextIsLevel = false;
+        std::string level;
+
+        void onStartObject() { ++depth; }
+        void onEndObject() { --depth; }
+        void onKey(std::string_view key) { nextIsLevel = depth == 1 && key == "level"; }
+        void onString(std::string_view str) {
+            if (nextIsLevel)
+                level = str;
+            nextIsLevel = false;
+        }
+    };
+
+    FieldExtractor extractor;
+    JsonParser::parseSax(R"({"msg": "started", "ctx": {"level": "debug"}, "level": "warn", "n": [1, 2]})"sv, extractor);
+    EXPECT_EQ(extractor.level, "warn");
+}
+
+TEST(JsonParser, LimitsNestingDepth) {
+    constexpr size_t kLevels = 1'000'000;
+    const std::string deep = std::string(kLevels, '[') + std::string(kLevels, ']');
+
+    // Hostile nesting is rejected without exhausting the stack
+    const JsonError error = JsonParser::tryParse(deep).error();
+    EXPECT_EQ(error.code, JsonErrorCode::DepthLimitExceeded);
+    EXPECT_EQ(error.offset, JsonParseOptions {}.maxDepth);
+    EXPECT_EQ(JsonParser::tryParseTape(deep).error().code, JsonErrorCode::DepthLimitExceeded);
+
+    // and accepted by the parsers that build no tree once allowed
+    struct DepthCounter : JsonSaxHandler {
+        size_t depth = 0, maxDepth = 0;
+
+        void onStartArray() { maxDepth = std::max(maxDepth, ++depth); }
+        void onEndArray() { --depth; }
+    };
+    const JsonParseOptions unlimited { .maxDepth = SIZE_MAX };
+    DepthCounter counter;
+    EXPECT_FALSE(JsonParser::tryParseSax(deep, counter, unlimited));
+    EXPECT_EQ(counter.maxDepth, kLevels);
+    EXPECT_EQ(counter.depth, 0u);
+    EXPECT_TRUE(JsonParser::parseTape(deep, unlimited).root().isArray());
+
+    DepthCounter streamed;
+    JsonStreamParser stream(streamed, unlimited);
+    stream.feed(deep);
+    stream.finish();
+    EXPECT_EQ(streamed.maxDepth, kLevels);
+    JsonStreamParser limited(streamed);
+    EXPECT_THROW(limited.feed(deep), std::runtime_error);
+
+    const JsonParseOptions two { .maxDepth = 2 };
+    EXPECT_EQ(JsonParser::parse("[{}, [1, []]]", JsonParseOptions { .maxDepth = 3 }), JsonParser::parse("[{}, [1, []]]"));
+    EXPECT_EQ(JsonParser::tryParse(R"({"a": [1, {"b": 2}]})", two).error().offset, 10u);
+    EXPECT_EQ(JsonParser::tryParseBinary(std::string(3, '\x91') + '\x01', JsonBinaryFormat::MessagePack, two).error().code, JsonErrorCode::DepthLimitExceeded);
+    EXPECT_EQ(JsonParser::tryParseBinary(std::string(2000, '\x81') + '\x01', JsonBinaryFormat::Cbor).error().offset, JsonParseOptions {}.maxDepth);
+}
+
+TEST(JsonStreamParser, AnyChunkBoundary) {
+    std::string_view jsonStr = R"( {"name": "Émoji 😃", "escape": "Tab:\t Quote:\" Unicode:✨ \ud83d\ude00\u00e9", "n": [-12, 3.5e-2, 0, true, false, null],
+        "nested": {"a": [[], {}], "b": {"c": "d"}}, "trailing": [1, 2,], "last": 42} )"sv;
+    const JsonValue expected = JsonParser::parse(jsonStr);
+
+    for (size_t chunkSize = 1; chunkSize <= jsonStr.size(); ++chunkSize) {
+        JsonDomHandler handler;
+        JsonStreamParser parser(handler);
+        for (size_t pos = 0; pos < jsonStr.size(); pos += chunkSize)
+            parser.feed(jsonStr.substr(pos, chunkSize));
+        parser.finish();
+        EXPECT_EQ(handler.value(), expected) << "chunk size " << chunkSize;
+    }
+}
+
+TEST(JsonStreamParser, RootScalars) {
+    for (auto jsonStr : { "42"sv, "-5.67E-8"sv, R"("str\"ing")"sv, "true"sv, "null"sv, " false "sv }) {
+        JsonDomHandler handler;
+        JsonStreamParser parser(handler);
+        parser.feed(jsonStr.substr(0, 2));
+        parser.feed(jsonStr.substr(2));
+        parser.finish();
+        EXPECT_TRUE(parser.done());
+        EXPECT_EQ(handler.value(), JsonParser::parse(jsonStr));
+    }
+}
+
+TEST(JsonStreamParser, RejectsInvalidJson) {
+    for (auto jsonStr : { "[1, 2"sv, R"({"a" 1})"sv, R"(["abc)"sv, "[tru]"sv, "[1 2]"sv, "{1: 2}"sv, "[1] 2"sv, "[1-2]"sv, ""sv, "[\"\xff\"]"sv, R"(["\ud83d"])"sv,
+             R"(["\ud83d\n"])"sv, R"(["\u12g4"])"sv }) {
+        JsonDomHandler handler;
+        JsonStreamParser parser(handler);
+        EXPECT_THROW(
+            {
+                parser.feed(jsonStr);
+                parser.finish();
+            },
+            std::runtime_error)
+            << jsonStr;
+    }
+
+    // The non-throwing API reports the error tryParse does, at its offset in
+    // the whole input however it was split
+    for (auto jsonStr : { "[1, 2"sv, R"({"a" 1})"sv, "[tru]"sv, "[1 2]"sv, "[1] 2"sv, "[-]"sv, "[\"ab\xff\"]"sv, R"(["a\ud83d"])"sv, R"(["\u12g4"])"sv }) {
+        const JsonError expected = JsonParser::tryParse(jsonStr).error();
+        for (const size_t chunkSize : { jsonStr.size(), size_t(1) }) {
+            JsonSaxHandler handler;
+            JsonStreamParser parser(handler);
+            JsonError error;
+            for (size_t pos = 0; pos < jsonStr.size() && !error; pos += chunkSize)
+                error = parser.tryFeed(jsonStr.substr(pos, chunkSize));
+            if (!error)
+                error = parser.tryFinish();
+            EXPECT_EQ(error.code, expected.code) << jsonStr;
+            EXPECT_EQ(error.offset, expected.offset) << jsonStr;
+            EXPECT_EQ(parser.tryFeed("1").code, expected.code);
+        }
+    }
+}
+
+TEST(JsonStreamParser, ReplacesLoneSurrogates) {
+    const std::string_view jsonStr = R"(["\ud83dx\ude00\ud83dA\ud83d\ud83d\ude00\ud83d\n", "\ud83d"])"sv;
+    const JsonValue expected = JsonParser::parse(jsonStr, { .replaceLoneSurrogates = true });
+    for (size_t split = 0; split <= jsonStr.size(); ++split) {
+        JsonDomHandler handler;
+        JsonStreamParser parser(handler, { .replaceLoneSurrogates = true });
+        parser.feed(jsonStr.substr(0, split));
+        parser.feed(jsonStr.substr(split));
+        parser.finish();
+        EXPECT_EQ(handler.value(), expected) << "split at " << split;
+    }
+}
+
+TEST(JsonLinesParser, SplitsAtNewlines) {
+    std::string ndjson;
+    for (int i = 0; i < 100; ++i) {
+        ndjson += R"({"id": )" + std::to_string(i) + R"(, "text": "a\"b)" + std::string(i % 70, 'x') + "\\nc\\\\\"}";
+        ndjson += i % 7 ? "\n" : "\r\n  \n";
+    }
+
+    const auto records = JsonLinesParser::split(ndjson, JsonSimdLevel::Scalar);
+    ASSERT_EQ(records.size(), 100u);
+    EXPECT_EQ(JsonParser::parse(records[42]).toObject()["id"].toInt(), 42);
+    for (auto level : { JsonSimdLevel::SSE2, JsonSimdLevel::SSE42, JsonSimdLevel::AVX2, JsonSimdLevel::AVX512 }) {
+        if (JsonSimd::isSupported(level)) {
+            EXPECT_EQ(JsonLinesParser::split(ndjson, level), records);
+        }
+    }
+    EXPECT_TRUE(JsonLinesParser::split("\n \n").empty());
+    EXPECT_EQ(JsonLinesParser::split("1\n2").size(), 2u);
+
+    // An unterminated string ends with its line
+    const std::string broken = "{\"a\": \"x}\n{\"b\": 1}\n{\"c\": 2}\n";
+    EXPECT_EQ(JsonLinesParser::split(broken), (std::vector<std::string_view> { "{\"a\": \"x}", "{\"b\": 1}", "{\"c\": 2}" }));
+    const auto results = JsonLinesParser(2).parse(broken);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].error().code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_EQ(results[2].value().toObject()["c"].toInt(), 2);
+}
+
+TEST(JsonLinesParser, ParsesInOrder) {
+    std::string ndjson;
+    std::vector<JsonValue> expected;
+    for (int i = 0; i < 5000; ++i) {
+        const std::string record = R"({"seq": )" + std::to_string(i) + R"(, "tags": ["x", "y"], "note": ")" + std::string(i % 300, 'n') + "\"}";
+        ndjson += record + "\n";
+        expected.push_back(JsonParser::parse(record));
+    }
+    ndjson += "[1, 2\n{\"a\": 1} {\"b\": 2}\n";
+
+    JsonLinesParser parser(4);
+    EXPECT_EQ(parser.threads(), 4u);
+    auto results = parser.parse(ndjson);
+    ASSERT_EQ(results.size(), 5002u);
+    for (size_t i = 0; i < expected.size(); ++i)
+        ASSERT_EQ(results[i].value(), expected[i]);
+    EXPECT_EQ(results[5000].error().code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_EQ(results[5001].error().code, JsonErrorCode::TrailingData);
+    EXPECT_EQ(results[5001].error().column, 10u);
+
+    size_t count = 0;
+    parser.forEach(ndjson, [&](std::string_view record, JsonResult<JsonValue>&& result) {
+        if (count < expected.size())
+            EXPECT_EQ(result.value(), JsonParser::parse(record));
+        else
+            EXPECT_FALSE(result);
+        ++count;
+    });
+    EXPECT_EQ(count, 5002u);
+}
+
+TEST(JsonLazyValue, NavigatesWithoutParsingSiblings) {
+    // Brackets and quotes inside strings, long strings spanning blocks and
+    // deep nesting must all be skipped correctly
+    std::string json = R"({"skip": {"a": ["]", "}", "\"]"], "b": [[[{}]]], "c": ")" + std::string(200, 'x') + R"("},)";
+    json += R"( "items": [1, -2.5, "three", [4], {"five": 5}, null, true,], "e\u0073caped": 6, "big": 18446744073709551615})";
+    JsonLazyValue root(json);
+    EXPECT_TRUE(root.isObject());
+    EXPECT_EQ(root.size(), 4u);
+
+    const auto items = root["items"];
+    EXPECT_TRUE(items.isArray());
+    EXPECT_EQ(items.size(), 7u);
+    EXPECT_EQ(items[0].toInt(), 1);
+    EXPECT_DOUBLE_EQ(items[1].toDouble(), -2.5);
+    EXPECT_EQ(items[2].toString(), "three");
+    EXPECT_EQ(items[3].raw(), "[4]");
+    EXPECT_EQ(items[4]["five"].toInt(), 5);
+    EXPECT_TRUE(items[5].isNull());
+    EXPECT_TRUE(items[6].toBool());
+    EXPECT_EQ(root["escaped"].toInt(), 6);
+    EXPECT_EQ(root["big"].toUInt64(), UINT64_MAX);
+    EXPECT_EQ(root["skip"]["c"].toString().size(), 200u);
+    EXPECT_EQ(root["skip"].materialize(), JsonParser::parse(root["skip"].raw()));
+
+    std::string keys;
+    root.forEachMember([&](std::string_view key, JsonLazyValue) { keys += std::string(key) + ","; });
+    EXPECT_EQ(keys, "skip,items,escaped,big,");
+    int sum = 0;
+    JsonLazyValue("[1, 2, 3]").forEachElement([&](JsonLazyValue v) { sum += v.toInt(); });
+    EXPECT_EQ(sum, 6);
+    EXPECT_EQ(JsonLazyValue(" {} ").size(), 0u);
+    EXPECT_FALSE(root.find("missing"));
+}
+
+TEST(JsonLazyValue, ThrowsOnAccess) {
+    JsonLazyValue root(R"({"a": [1, 2], "b": tru, "c": {"d": [})");
+    EXPECT_EQ(root["a"][1].toInt(), 2);
+    EXPECT_THROW(root["missing"], std::runtime_error);
+    EXPECT_THROW(root["a"][2], std::runtime_error);
+    EXPECT_THROW(root["a"]["x"], std::runtime_error);
+    EXPECT_THROW(root[0], std::runtime_error);
+    EXPECT_THROW(root["b"].toBool(), std::runtime_error);
+    EXPECT_THROW(root["a"].toInt(), std::runtime_error);
+    EXPECT_THROW(root["c"].raw(), std::runtime_error);
+    EXPECT_THROW(root.size(), std::runtime_error);
+
+    // tryMaterialize locates the error in the whole text
+    const JsonError error = root["b"].tryMaterialize().error();
+    EXPECT_EQ(error.code, JsonErrorCode::ExpectedTrue);
+    EXPECT_EQ(error.offset, 19u);
+    EXPECT_EQ(root["a"].tryMaterialize().value(), JsonParser::parse("[1, 2]"));
+}
+
+TEST(JsonLazyValue, AppliesParseOptions) {
+    const std::string_view json = "{\"s\": [\"\xff\", \"\\ud83d\"], \"big\": 123456789012345678901234567890, \"deep\": [[[1]]]}";
+    const JsonLazyValue strict(json);
+    EXPECT_EQ(strict["s"][0].tryMaterialize().error().code, JsonErrorCode::InvalidUtf8);
+    EXPECT_EQ(strict["s"][1].tryMaterialize().error().code, JsonErrorCode::InvalidCodepoint);
+    EXPECT_TRUE(strict["big"].materialize().isDouble());
+    EXPECT_TRUE(strict["deep"].tryMaterialize());
+
+    // Options carry over to every value reached from the root
+    const JsonLazyValue lenient(json, { .rawBigIntegers = true, .validateUtf8 = false, .replaceLoneSurrogates = true, .maxDepth = 2 });
+    EXPECT_EQ(lenient["s"][0].toString(), "\xff");
+    EXPECT_EQ(lenient["s"][1].toString(), "\xef\xbf\xbd");
+    EXPECT_TRUE(lenient["big"].materialize().isRawNumber());
+    EXPECT_EQ(lenient["deep"].tryMaterialize().error().code, JsonErrorCode::DepthLimitExceeded);
+    EXPECT_EQ(lenient["deep"][0].materialize(), JsonParser::parse("[[1]]"));
+}
+
+TEST(JsonPath, SelectsFromTreesAndText) {
+    const std::string json = R"({"store": {"book": [{"title": "A", "price": 8}, {"title": "B", "price": 12.5}, {"title": "C"}],
+        "bicycle": {"price": 20}}, "a/b": 1, "m~n": 2, "odd 'key'": [0, 1, 2, 3, 4, 5], "escaped": true})";
+    JsonValue tree = JsonParser::parse(json);
+    // Every match as compact JSON, from the tree and from the text
+    const auto matches = [&](std::string_view path) {
+        const JsonPath compiled = JsonPath::compile(path);
+        std::string fromTree, fromText;
+        compiled.forEach(tree, [&](const JsonValue& value) { fromTree += JsonWriter::dump(value) + " "; });
+        compiled.forEach(JsonLazyValue(json), [&](const JsonLazyValue& value) { fromText += JsonWriter::dump(value.materialize()) + " "; });
+        EXPECT_EQ(fromTree, fromText) << path;
+        return fromTree;
+    };
+
+    EXPECT_EQ(matches("/store/book/1/title"), "\"B\" ");
+    EXPECT_EQ(matches("/a~1b"), "1 ");
+    EXPECT_EQ(matches("/m~0n"), "2 ");
+    EXPECT_EQ(matches("/store/book/3"), "");
+    EXPECT_EQ(matches("/store/book/-"), "");
+    EXPECT_EQ(matches("/store/book/01"), "");
+    EXPECT_EQ(JsonPath::compile("").find(tree), &tree);
+
+    EXPECT_EQ(matches("$.store.book[*].title"), "\"A\" \"B\" \"C\" ");
+    EXPECT_EQ(matches("$..price"), "8 12.5 20 ");
+    EXPECT_EQ(matches("$.store.book[-1]"), "{\"title\":\"C\"} ");
+    EXPECT_EQ(matches(R"($["odd 'key'"][1:5:2])"), "1 3 ");
+    EXPECT_EQ(matches(R"($['odd \'key\''][::-2])"), "5 3 1 ");
+    EXPECT_EQ(matches("$['odd \\'key\\''][-2:]"), "4 5 ");
+    EXPECT_EQ(matches("$.escaped"), "true ");
+    EXPECT_EQ(matches("$.store.*.price"), "20 ");
+    EXPECT_EQ(matches("$..book[0].title"), "\"A\" ");
+    EXPECT_EQ(matches("$.store.book.title"), "");
+
+    // Matches of a mutable tree can be edited in place
+    for (JsonValue* price : JsonPath::compile("$..price").select(tree))
+        *price = 0;
+    EXPECT_EQ(JsonPath::compile("$..price").select(std::as_const(tree)).size(), 3u);
+    EXPECT_EQ(*JsonPath::compile("/store/bicycle/price").find(std::as_const(tree)), JsonValue(0));
+    EXPECT_EQ(JsonPath::compile("$.store.book[1].title").find(JsonLazyValue(json))->toString(), "B");
+    EXPECT_FALSE(JsonPath::compile("$.missing").find(JsonLazyValue(json)));
+}
+
+TEST(JsonPath, RejectsInvalidPaths) {
+    for (const char* path : { "$.", "$..", "$[", "$[1", "$[]", "$[1:2:3:4]", "$['a]", "$x", "store", "/~2", "$.a.[0]", "$[1234567890123456]" })
+        EXPECT_EQ(JsonPath::tryCompile(path).error().code, JsonErrorCode::InvalidPath) << path;
+    EXPECT_EQ(JsonPath::tryCompile("$.a b").error().offset, 3u);
+    EXPECT_THROW(JsonPath::compile("$.a["), std::runtime_error);
+    EXPECT_THROW(JsonPath::compile("$.a[0]").find(JsonLazyValue(R"({"a" [0]})")), std::runtime_error);
+}
+
+TEST(JsonTape, MatchesTree) {
+    const std::string json = R"({"name": "a\"b", "n": [0, -1, 3000000000, 18446744073709551615, 1.5e3, true, false, null],
+        "nested": {"empty": {}, "list": [[], [{}]]}, "big": 123456789012345678901234567890})";
+    JsonTape tape = JsonParser::parseTape(json, { .rawBigIntegers = true });
+    EXPECT_EQ(tape.root().materialize(), JsonParser::parse(json, { .rawBigIntegers = true }));
+
+    const auto root = tape.root();
+    EXPECT_TRUE(root.isObject());
+    EXPECT_EQ(root.size(), 4u);
+    EXPECT_EQ(root["name"].toString(), "a\"b");
+    const auto n = root["n"];
+    EXPECT_EQ(n.size(), 8u);
+    EXPECT_EQ(n[1].toInt(), -1);
+    EXPECT_EQ(n[2].toInt64(), 3000000000);
+    EXPECT_EQ(n[3].toUInt64(), UINT64_MAX);
+    EXPECT_THROW(n[3].toInt64(), std::runtime_error);
+    EXPECT_DOUBLE_EQ(n[4].toDouble(), 1500.0);
+    EXPECT_TRUE(n[5].toBool());
+    EXPECT_TRUE(n[7].isNull());
+    EXPECT_THROW(n[8], std::runtime_error);
+    EXPECT_EQ(root["nested"]["list"][1][0].size(), 0u);
+    EXPECT_EQ(root["big"].toRawNumber(), "123456789012345678901234567890");
+    EXPECT_FALSE(root.find("missing"));
+    EXPECT_THROW(root["name"].toInt(), std::runtime_error);
+
+    std::string keys;
+    root.forEachMember([&](std::string_view key, JsonTapeView) { keys += std::string(key) + ","; });
+    EXPECT_EQ(keys, "name,n,nested,big,");
+
+    // Views stay valid when the tape moves
+    JsonTape moved = std::move(tape);
+    EXPECT_EQ(root["name"].toString(), "a\"b");
+    EXPECT_EQ(JsonParser::parseTape(" 7 ").root().toInt(), 7);
+    EXPECT_EQ(JsonParser::tryParseTape(R"({"a": [1, 2})").error().code, JsonErrorCode::ExpectedCommaOrBracket);
+}
+
+TEST(JsonTape, ParseStatic) {
+    using namespace auric_json_literals;
+    static constexpr auto config = R"({"name": "caf\u00e9", "retries": 3, "timeout": 2.5, "big": 3000000000,
+        "hosts": ["a", "b"], "limits": {"depth": -1, "strict": true, "fallback": null}})"_json;
+    static_assert(config.root()["retries"].toInt() == 3);
+    static_assert(config.root()["name"].toString() == "café");
+    static_assert(config.root()["hosts"].size() == 2);
+    static_assert(config.root()["limits"]["depth"].toInt() == -1);
+    static_assert(!config.root().find("missing"));
+
+    // The same values at run time as from a tape parsed then
+    const JsonTape tape = JsonParser::parseTape(R"({"name": "caf\u00e9", "retries": 3, "timeout": 2.5, "big": 3000000000,
+        "hosts": ["a", "b"], "limits": {"depth": -1, "strict": true, "fallback": null}})");
+    EXPECT_EQ(config.root().materialize(), tape.root().materialize());
+    EXPECT_DOUBLE_EQ(config.root()["timeout"].toDouble(), 2.5);
+    EXPECT_EQ(config.root()["big"].toInt64(), 3000000000);
+    EXPECT_TRUE(config.root()["limits"]["fallback"].isNull());
+    EXPECT_THROW(config.root()["hosts"][2], std::runtime_error);
+
+    static constexpr auto scalar = JsonParser::parseStatic<" \"x\" ">();
+    EXPECT_EQ(scalar.root().toString(), "x");
+    static constexpr auto raw = JsonParser::parseStatic<"[123456789012345678901234567890]", { .rawBigIntegers = true }>();
+    EXPECT_EQ(raw.root()[0].toRawNumber(), "123456789012345678901234567890");
+}
+
+struct Address {
+    std::string city;
+    std::optional<int> zip;
+};
+
+template <>
+struct JsonFields<Address> {
+    static constexpr std::tuple fields { JsonField { "city", &Address::city }, JsonField { "zip", &Address::zip } };
+};
+
+struct Person {
+    std::string name;
+    uint8_t age = 0;
+    double height = 0;
+    bool married = false;
+    std::vector<Address> addresses;
+    std::map<std::string, std::vector<int>> scores;
+    JsonValue extra;
+};
+
+template <>
+struct JsonFields<Person> {
+    static constexpr std::tuple fields { JsonField { "name", &Person::name }, JsonField { "age", &Person::age },
+        JsonField { "height", &Person::height }, JsonField { "married", &Person::married }, JsonField { "addresses", &Person::addresses },
+        JsonField { "scores", &Person::scores }, JsonField { "extra", &Person::extra } };
+};
+
+TEST(JsonParser, ParseAsStructs) {
+    const Person person = JsonParser::parseAs<Person>(R"({
+        "name": "Ann \"A\"", "unknown": {"deep": [1, {"x": null}]}, "age": 42, "height": 2,
+        "addresses": [{"city": "Oslo", "zip": 150}, {"city": "Rome", "zip": null}, {"city": "Lima"},],
+        "scores": {"math": [1, 2], "art": []}, "married": true, "extra": {"any": [true]}
+    })");
+    EXPECT_EQ(person.name, "Ann \"A\"");
+    EXPECT_EQ(person.age, 42);
+    EXPECT_DOUBLE_EQ(person.height, 2.0);
+    EXPECT_TRUE(person.married);
+    ASSERT_EQ(person.addresses.size(), 3u);
+    EXPECT_EQ(person.addresses[0].zip, 150);
+    EXPECT_FALSE(person.addresses[1].zip);
+    EXPECT_EQ(person.addresses[2].city, "Lima");
+    EXPECT_EQ(person.scores.at("math"), (std::vector<int> { 1, 2 }));
+    EXPECT_TRUE(person.scores.at("art").empty());
+    EXPECT_EQ(person.extra, JsonParser::parse(R"({"any": [true]})"));
+
+    EXPECT_EQ(JsonParser::parseAs<std::vector<std::optional<int64_t>>>("[1, null, -3]"), (std::vector<std::optional<int64_t>> { 1, std::nullopt, -3 }));
+    EXPECT_EQ(JsonParser::parseAs<Person>("{}").name, "");
+
+    const auto mismatch = [](std::string_view json) { return JsonParser::tryParseAs<Person>(json).error(); };
+    EXPECT_EQ(mismatch(R"({"age": 300})").code, JsonErrorCode::UnexpectedType);
+    EXPECT_EQ(mismatch(R"({"age": 1.5})").code, JsonErrorCode::UnexpectedType);
+    EXPECT_EQ(mismatch(R"({"name": 1})").offset, 9u);
+    EXPECT_EQ(mismatch(R"({"married": tru})").code, JsonErrorCode::ExpectedTrue);
+    EXPECT_EQ(mismatch(R"({"addresses": [{"zip": "1"}]})").code, JsonErrorCode::UnexpectedType);
+    EXPECT_EQ(mismatch(R"({"unknown": [1, 2)").code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_EQ(mismatch("[]").code, JsonErrorCode::UnexpectedType);
+    EXPECT_THROW(JsonParser::parseAs<std::string>("null"), std::runtime_error);
+}
+
+struct Node {
+    std::vector<Node> k;
+    JsonValue extra;
+};
+
+template <>
+struct JsonFields<Node> {
+    static constexpr std::tuple fields { JsonField { "k", &Node::k }, JsonField { "extra", &Node::extra } };
+};
+
+TEST(JsonParser, ParseAsDepthLimit) {
+    const auto nested = [](size_t depth) {
+        std::string json;
+        for (size_t i = 0; i < depth; ++i)
+            json += R"({"k":[)";
+        return json;
+    };
+    EXPECT_EQ(JsonParser::parseAs<Node>(R"({"k": [{"k": []}, {}]})").k.size(), 2u);
+    const auto deep = JsonParser::tryParseAs<Node>(nested(2000000));
+    EXPECT_EQ(deep.error().code, JsonErrorCode::DepthLimitExceeded);
+    EXPECT_EQ(deep.error().offset, 1024 / 2 * 6u);
+
+    // Values parsed or skipped as trees count from the depth they start at
+    const JsonParseOptions shallow { .maxDepth = 4 };
+    EXPECT_TRUE(JsonParser::tryParseAs<Node>(R"({"k": [{"extra": [1]}]})", shallow));
+    EXPECT_EQ(JsonParser::tryParseAs<Node>(R"({"k": [{"extra": [[1]]}]})", shallow).error().code, JsonErrorCode::DepthLimitExceeded);
+    EXPECT_EQ(JsonParser::tryParseAs<Node>(R"({"k": [{"skipped": [[1]]}]})", shallow).error().code, JsonErrorCode::DepthLimitExceeded);
+}
+
+TEST(JsonParser, BinaryRoundTrip) {
+    JsonValue value = JsonParser::parse(R"({"ints": [0, 23, 24, 255, 256, -1, -24, -25, -32, -33, -129, 65536, -2147483649,
+        9223372036854775807, -9223372036854775808, 18446744073709551615], "doubles": [1.5, 0.1, -1e300],
+        "strings": ["", "x", "é中"], "nested": {"a": {"b": [[], {}, null, true, false]}}})");
+    auto& obj = std::get<JsonValue::Object>(value.value);
+    obj.members.emplace_back("long", std::string(70000, 'y'));
+    JsonValue::Array wide;
+    for (int i = 0; i < 20; ++i)
+        wide.elements.emplace_back(i);
+    obj.members.emplace_back("wide", std::move(wide));
+
+    for (const auto format : { JsonBinaryFormat::Cbor, JsonBinaryFormat::MessagePack }) {
+        const std::string bytes = JsonWriter::dumpBinary(value, format);
+        EXPECT_EQ(JsonParser::parseBinary(bytes, format), value);
+        const JsonDocument doc = JsonParser::parseBinaryDocument(bytes, format, { .borrowStrings = true });
+        EXPECT_EQ(JsonWriter::dump(doc.root()), JsonWriter::dump(value));
+        EXPECT_EQ(JsonParser::tryParseBinary(bytes.substr(0, bytes.size() - 1), format).error().code, JsonErrorCode::UnexpectedEnd);
+        EXPECT_EQ(JsonParser::tryParseBinary(bytes + '\0', format).error().code, JsonErrorCode::TrailingData);
+    }
+
+    const std::string small = R"({"a":[1,-1]})";
+    EXPECT_EQ(JsonWriter::dumpBinary(JsonParser::parse(small), JsonBinaryFormat::Cbor), "\xA1\x61\x61\x82\x01\x20");
+    EXPECT_EQ(JsonWriter::dumpBinary(JsonParser::parse(small), JsonBinaryFormat::MessagePack), "\x81\xA1\x61\x92\x01\xFF");
+
+    const std::string big = "[123456789012345678901234567890, -18446744073709551617, -18446744073709551616]";
+    const JsonValue bigValue = JsonParser::parse(big, { .rawBigIntegers = true });
+    const std::string bigBytes = JsonWriter::dumpBinary(bigValue, JsonBinaryFormat::Cbor);
+    EXPECT_EQ(JsonParser::parseBinary(bigBytes, JsonBinaryFormat::Cbor, { .rawBigIntegers = true }), bigValue);
+    EXPECT_EQ(JsonParser::parseBinary(bigBytes, JsonBinaryFormat::Cbor), JsonParser::parse(big));
+}
+
+TEST(JsonParser, BinaryDecodesForeignEncodings) {
+    const auto cbor = [](std::string_view bytes) { return JsonParser::tryParseBinary(bytes, JsonBinaryFormat::Cbor); };
+    // Indefinite lengths, half floats, undefined and ignored tags
+    EXPECT_EQ(cbor(std::string_view("\xBF\x7F\x61\x6B\x61\x31\xFF\x9F\xF9\x3C\x00\xF7\xC1\x1A\x00\x01\x00\x00\xFF\xFF", 20)).value(),
+        JsonParser::parse(R"({"k1": [1.0, null, 65536]})"));
+    EXPECT_EQ(cbor("\x3B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF").value(), JsonParser::parse("-18446744073709551616"));
+    EXPECT_EQ(cbor("\x41x").error().code, JsonErrorCode::InvalidBinary);
+    EXPECT_EQ(cbor("\xA1\x01\x02").error().offset, 1u);
+    EXPECT_EQ(cbor("\x9B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x01").error().code, JsonErrorCode::UnexpectedEnd);
+    EXPECT_EQ(cbor("").error().code, JsonErrorCode::UnexpectedEnd);
+
+    const auto msgpack = [](std::string_view bytes) { return JsonParser::tryParseBinary(bytes, JsonBinaryFormat::MessagePack); };
+    EXPECT_EQ(msgpack(std::string_view("\x93\xD0\x80\xD1\xFF\x7F\xCF\x00\x00\x00\x00\x00\x00\x01\x00", 15)).value(), JsonParser::parse("[-128, -129, 256]"));
+    EXPECT_EQ(msgpack("\xC1").error().code, JsonErrorCode::InvalidBinary);
+    EXPECT_EQ(msgpack("\x81\x01\x02").error().offset, 1u);
+    EXPECT_THROW(JsonParser::parseBinary("\xC4\x01x", JsonBinaryFormat::MessagePack), std::runtime_error);
+}
+
+TEST(JsonWriter, Compact) {
+    std::string_view jsonStr = R"( {"name": "John", "age": 30, "score": 7.5, "tags": ["a", [], {}], "married": false, "address": null} )"sv;
+    EXPECT_EQ(JsonWriter::dump(JsonParser::parse(jsonStr)), R"({"name":"John","age":30,"score":7.5,"tags":["a",[],{}],"married":false,"address":null})");
+    EXPECT_EQ(JsonWriter::dump(JsonParser::parseDocument(jsonStr).root()), JsonWriter::dump(JsonParser::parse(jsonStr)));
+}
+
+TEST(JsonWriter, Pretty) {
+    const JsonValue value = JsonParser::parse(R"({"a": [1, {"b": null}], "c": {}})"sv);
+    EXPECT_EQ(JsonWriter::dump(value, { .pretty = true, .indent = 2 }), "{\n"
+                                                                         "  \"a\": [\n"
+                                                                         "    1,\n"
+                                                                         "    {\n"
+                                                                         "      \"b\": null\n"
+                                                                         "    }\n"
+                                                                         "  ],\n"
+                                                                         "  \"c\": {}\n"
+                                                                         "}");
+    EXPECT_EQ(JsonParser::parse(JsonWriter::dump(value, { .pretty = true })), value);
+}
+
+TEST(JsonWriter, EscapesStrings) {
+    std::string str = "Quote:\" Backslash:\\ Slash:/ Tab:\t Newline:\n Bell:\x07 Unicode:✨ ";
+    str += std::string(40, 'x') + "\"";
+    const std::string json = JsonWriter::dump(JsonValue(str));
+    EXPECT_EQ(json, "\"Quote:\\\" Backslash:\\\\ Slash:/ Tab:\\t Newline:\\n Bell:\\u0007 Unicode:✨ " + std::string(40, 'x') + "\\\"\"");
+    EXPECT_EQ(JsonParser::parse(json), JsonValue(str));
+}
+
+TEST(JsonWriter, Numbers) {
+    EXPECT_EQ(JsonWriter::dump(JsonValue(0.1)), "0.1");
+    EXPECT_EQ(JsonWriter::dump(JsonValue(1.0)), "1.0");
+    EXPECT_EQ(JsonWriter::dump(JsonValue(-2.5e-300)), "-2.5e-300");
+    EXPECT_EQ(JsonWriter::dump(JsonValue(std::numeric_limits<int>::min())), "-2147483648");
+    EXPECT_EQ(JsonWriter::dump(JsonValue(std::numeric_limits<double>::quiet_NaN())), "null");
+
+    for (double d : { 0.1, 1.0 / 3.0, 1e300, 5e-324, 123456.789, -0.0 }) {
+        EXPECT_EQ(JsonValue::toDouble(JsonParser::parse(JsonWriter::dump(JsonValue(d)))), d);
+    }
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();